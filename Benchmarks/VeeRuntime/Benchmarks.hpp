@@ -0,0 +1,40 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+namespace ankerl::nanobench {
+class Bench;
+} // namespace ankerl::nanobench
+
+namespace vee::bench {
+/**
+ * Hand a finished benchmark over to be included in the JSON output, if any was requested on the
+ * command line. Call once per Bench after its last run.
+ */
+void report(const ankerl::nanobench::Bench& bench);
+
+void fiber_switch();
+void fiber_create();
+void job_manager_scaling();
+void job_manager_producers();
+void job_manager_fan_out();
+void job_manager_placement();
+void job_manager_fan_in();
+void job_manager_leaf();
+void job_manager_yield();
+void job_manager_wake_latency();
+void job_graph_replay();
+} // namespace vee::bench
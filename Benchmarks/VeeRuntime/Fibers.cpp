@@ -0,0 +1,65 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Benchmarks.hpp"
+
+#include <Fibers.hpp>
+
+#include <nanobench.h>
+
+namespace vee::bench {
+namespace {
+Fiber main_fiber;
+Fiber echo_fiber;
+
+/**
+ * Switches straight back to whoever switched to it, so that one switch_to_fiber call on the main
+ * fiber measures a full round trip.
+ */
+[[noreturn]] void echo_main() {
+    while (true) {
+        switch_to_fiber(main_fiber);
+    }
+}
+} // namespace
+
+void fiber_switch() {
+    ankerl::nanobench::Bench bench;
+    bench.title("Fibers").unit("round trip");
+
+    convert_thread_to_fiber(main_fiber);
+    echo_fiber = create_fiber(echo_main, "echo"_hash);
+    bench.run("switch_to_fiber round trip", [] {
+        switch_to_fiber(echo_fiber);
+    });
+    destroy_fiber(echo_fiber);
+    convert_fiber_to_thread();
+
+    report(bench);
+}
+
+void fiber_create() {
+    ankerl::nanobench::Bench bench;
+    bench.title("Fibers").unit("fiber");
+
+    bench.run("create_fiber + destroy_fiber", [] {
+        // Never switched to, this only measures allocating and releasing the stack
+        Fiber fiber = create_fiber(echo_main, "unused"_hash);
+        destroy_fiber(fiber);
+    });
+
+    report(bench);
+}
+} // namespace vee::bench
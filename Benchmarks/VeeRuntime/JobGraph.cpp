@@ -0,0 +1,86 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Benchmarks.hpp"
+
+#include <JobGraph.hpp>
+#include <JobManager.hpp>
+
+#include <nanobench.h>
+
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace vee::bench {
+namespace {
+// A frame shaped graph: layers of independent nodes, every node depending on the whole previous
+// layer.
+constexpr uint32_t GRAPH_WIDTH = 16;
+constexpr uint32_t GRAPH_DEPTH = 8;
+
+void empty_node() {}
+
+void wait_for(const JobCounter& counter) {
+    while (!counter.is_complete()) {
+        std::this_thread::yield();
+    }
+}
+} // namespace
+
+void job_graph_replay() {
+    ankerl::nanobench::Bench bench;
+    bench.title("JobGraph replay").unit("node").batch(GRAPH_WIDTH * GRAPH_DEPTH).relative(true);
+
+    JobManager::init();
+
+    // The same frame built by hand every time, with one counter per layer
+    bench.run("queue_jobs per layer", [] {
+        std::array<PaddedJobCounter, GRAPH_DEPTH> layer_counters;
+        std::array<JobDecl, GRAPH_WIDTH> decls;
+        for (uint32_t layer = 0; layer < GRAPH_DEPTH; ++layer) {
+            decls.fill({"node"_hash, empty_node, &layer_counters[layer]});
+            JobManager::queue_jobs(decls, layer == 0 ? nullptr : &layer_counters[layer - 1]);
+        }
+        for (const JobCounter& counter : layer_counters) {
+            wait_for(counter);
+        }
+    });
+
+    JobGraph graph;
+    std::vector<JobGraphNode> previous_layer;
+    std::vector<JobGraphNode> layer;
+    for (uint32_t depth = 0; depth < GRAPH_DEPTH; ++depth) {
+        layer.clear();
+        for (uint32_t i = 0; i < GRAPH_WIDTH; ++i) {
+            const JobGraphNode node = graph.add_node("node"_hash, empty_node);
+            for (const JobGraphNode dependency : previous_layer) {
+                graph.add_dependency(dependency, node);
+            }
+            layer.push_back(node);
+        }
+        std::swap(previous_layer, layer);
+    }
+    graph.compile();
+
+    bench.run("JobGraph::run", [&] {
+        graph.run();
+        wait_for(graph.counter());
+    });
+
+    JobManager::shutdown();
+    report(bench);
+}
+} // namespace vee::bench
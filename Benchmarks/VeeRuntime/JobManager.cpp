@@ -0,0 +1,341 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Benchmarks.hpp"
+
+#include <JobManager.hpp>
+
+#include <nanobench.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <print>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vee::bench {
+namespace {
+constexpr uint32_t JOBS_PER_BATCH = 1024;
+constexpr uint32_t CHILDREN_PER_JOB = 16;
+
+JobCounter batch_counter;
+
+void empty_job() {}
+
+/**
+ * Queues children from inside a worker so that they land on the worker's own deque and have to be
+ * stolen by everyone else.
+ */
+void spawning_job() {
+    for (uint32_t i = 0; i < CHILDREN_PER_JOB; ++i) {
+        JobManager::queue_job({"child"_hash, empty_job, &batch_counter});
+    }
+}
+
+/**
+ * @return The worker count JobManager::init picks on this machine.
+ */
+std::size_t default_worker_count() {
+    JobManager::init();
+    const std::size_t num_workers = JobManager::num_workers();
+    JobManager::shutdown();
+    return num_workers;
+}
+
+void wait_for_batch() {
+    while (!batch_counter.is_complete()) {
+        std::this_thread::yield();
+    }
+}
+
+constexpr std::size_t FAN_OUT_ELEMENTS = 16384;
+
+std::vector<float> fan_out_data(FAN_OUT_ELEMENTS);
+
+void update_element(float& element) {
+    element = element * 0.5f + 1.0f;
+}
+
+// Sized to fit in the last level cache of a single CCD, but be shared by every worker
+constexpr std::size_t SHARED_DATA_ELEMENTS = 1024 * 1024;
+
+std::vector<float> shared_data(SHARED_DATA_ELEMENTS, 1.0f);
+
+std::atomic<std::chrono::steady_clock::rep> job_start_time = 0;
+
+void timestamp_job() {
+    job_start_time.store(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+constexpr uint32_t JOBS_PER_PRODUCER = 16384;
+
+constexpr uint32_t TINY_JOBS = 16384;
+
+std::atomic<uint32_t> tiny_job_sink = 0;
+
+void tiny_job() {
+    tiny_job_sink.fetch_add(1, std::memory_order_relaxed);
+}
+
+constexpr uint32_t FAN_IN_ROOTS = 64;
+constexpr uint32_t FAN_IN_CHILDREN = 64;
+
+/**
+ * Spreads work out and suspends until all of it is done, the common shape of a frame's jobs.
+ */
+void fan_in_root() {
+    JobCounter children;
+    std::array<JobDecl, FAN_IN_CHILDREN> decls;
+    decls.fill({"child"_hash, empty_job, &children});
+    JobManager::queue_jobs(decls);
+    JobManager::wait_for_counter(&children);
+}
+
+constexpr uint32_t YIELDS_PER_JOB = 256;
+constexpr uint32_t YIELDING_JOBS_PER_WORKER = 4;
+
+void yielding_job() {
+    for (uint32_t i = 0; i < YIELDS_PER_JOB; ++i) {
+        JobManager::yield();
+    }
+}
+
+constexpr uint32_t CHAIN_LENGTH = 64;
+constexpr uint32_t NUM_CHAINS = 16;
+
+/**
+ * Each link waits on the next one, so a whole chain of suspended fibers builds up before it
+ * unwinds from the far end.
+ */
+void chain_link(uint32_t remaining) {
+    if (remaining == 0) {
+        return;
+    }
+    JobCounter next;
+    JobManager::queue_job({"link"_hash, [remaining] { chain_link(remaining - 1); }, &next});
+    JobManager::wait_for_counter(&next);
+}
+} // namespace
+
+void job_manager_scaling() {
+    const std::size_t max_workers = default_worker_count();
+
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager scaling").unit("job").batch(JOBS_PER_BATCH * (CHILDREN_PER_JOB + 1)).relative(true);
+
+    for (std::size_t num_workers = 1;; num_workers = std::min(num_workers * 2, max_workers)) {
+        JobManager::init({.num_workers = num_workers});
+        bench.run(std::to_string(num_workers) + " workers", [] {
+            for (uint32_t i = 0; i < JOBS_PER_BATCH; ++i) {
+                JobManager::queue_job({"spawner"_hash, spawning_job, &batch_counter});
+            }
+            wait_for_batch();
+        });
+        JobManager::shutdown();
+
+        if (num_workers == max_workers) {
+            break;
+        }
+    }
+    report(bench);
+}
+
+void job_manager_producers() {
+    const std::size_t max_producers = std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1);
+
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager producers").unit("job").relative(true);
+
+    JobManager::init();
+    for (std::size_t num_producers = 1;; num_producers = std::min(num_producers * 2, max_producers)) {
+        // Threads outside the pool all go through the injection queue. Starting them is cheap
+        // next to the number of jobs each of them queues.
+        bench.batch(JOBS_PER_PRODUCER * num_producers).run(std::to_string(num_producers) + " producers", [num_producers] {
+            std::vector<std::thread> producers;
+            producers.reserve(num_producers);
+            for (std::size_t i = 0; i < num_producers; ++i) {
+                producers.emplace_back([] {
+                    for (uint32_t job = 0; job < JOBS_PER_PRODUCER; ++job) {
+                        JobManager::queue_job({"produced"_hash, empty_job, &batch_counter});
+                    }
+                });
+            }
+            for (std::thread& producer : producers) {
+                producer.join();
+            }
+            wait_for_batch();
+        });
+
+        if (num_producers == max_producers) {
+            break;
+        }
+    }
+    JobManager::shutdown();
+    report(bench);
+}
+
+void job_manager_fan_out() {
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager fan-out").unit("element").batch(FAN_OUT_ELEMENTS).relative(true);
+
+    JobManager::init();
+    bench.run("queue_job per element", [] {
+        for (float& element : fan_out_data) {
+            JobManager::queue_job({"element"_hash, [&element] { update_element(element); }, &batch_counter});
+        }
+        wait_for_batch();
+    });
+
+    std::vector<JobDecl> decls;
+    decls.reserve(FAN_OUT_ELEMENTS);
+    for (float& element : fan_out_data) {
+        decls.push_back({"element"_hash, [&element] { update_element(element); }, &batch_counter});
+    }
+    bench.run("queue_jobs", [&] {
+        JobManager::queue_jobs(decls);
+        wait_for_batch();
+    });
+
+    bench.run("parallel_for", [] {
+        JobManager::parallel_for(fan_out_data, 256, update_element);
+    });
+    JobManager::shutdown();
+    report(bench);
+}
+
+void job_manager_fan_in() {
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager fan-in").unit("job").relative(true);
+
+    JobManager::init();
+    bench.batch(FAN_IN_ROOTS * (FAN_IN_CHILDREN + 1)).run("wait_for_counter on children", [] {
+        for (uint32_t i = 0; i < FAN_IN_ROOTS; ++i) {
+            JobManager::queue_job({"root"_hash, fan_in_root, &batch_counter});
+        }
+        wait_for_batch();
+    });
+    bench.batch(NUM_CHAINS * CHAIN_LENGTH).run("nested wait chains", [] {
+        for (uint32_t i = 0; i < NUM_CHAINS; ++i) {
+            JobManager::queue_job({"link"_hash, [] { chain_link(CHAIN_LENGTH - 1); }, &batch_counter});
+        }
+        wait_for_batch();
+    });
+    JobManager::shutdown();
+    report(bench);
+}
+
+void job_manager_leaf() {
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager leaf jobs").unit("job").batch(TINY_JOBS).relative(true);
+
+    JobManager::init();
+    for (const bool leaf : {false, true}) {
+        std::vector<JobDecl> decls(TINY_JOBS, {.name = "tiny"_hash, .entry = tiny_job, .signal_counter = &batch_counter, .leaf = leaf});
+        bench.run(leaf ? "leaf, on the worker stack" : "on a fiber", [&] {
+            JobManager::queue_jobs(decls);
+            wait_for_batch();
+        });
+    }
+    JobManager::shutdown();
+    report(bench);
+}
+
+void job_manager_yield() {
+    JobManager::init();
+    const auto num_jobs = static_cast<uint32_t>(JobManager::num_workers()) * YIELDING_JOBS_PER_WORKER;
+
+    ankerl::nanobench::Bench bench;
+    bench.title("JobManager yield").unit("yield").batch(num_jobs * YIELDS_PER_JOB);
+    bench.run(std::to_string(YIELDING_JOBS_PER_WORKER) + " yielding jobs per worker", [num_jobs] {
+        for (uint32_t i = 0; i < num_jobs; ++i) {
+            JobManager::queue_job({"yielder"_hash, yielding_job, &batch_counter});
+        }
+        wait_for_batch();
+    });
+    JobManager::shutdown();
+    report(bench);
+}
+
+void job_manager_placement() {
+    // Same number of workers for every policy, so that only their placement differs
+    const std::size_t num_workers = default_worker_count();
+
+    constexpr std::pair<WorkerPlacement, const char*> PLACEMENTS[] = {
+        {WorkerPlacement::SharedCache, "shared cache"},
+        {WorkerPlacement::PhysicalCores, "physical cores"},
+        {WorkerPlacement::Unpinned, "unpinned"},
+    };
+
+    ankerl::nanobench::Bench steal_bench;
+    steal_bench.title("JobManager placement: spawning jobs").unit("job").batch(JOBS_PER_BATCH * (CHILDREN_PER_JOB + 1)).relative(true);
+    ankerl::nanobench::Bench shared_data_bench;
+    shared_data_bench.title("JobManager placement: shared data").unit("element").batch(SHARED_DATA_ELEMENTS).relative(true);
+
+    for (const auto& [placement, name] : PLACEMENTS) {
+        JobManager::init({.num_workers = num_workers, .placement = placement});
+        steal_bench.run(name, [] {
+            for (uint32_t i = 0; i < JOBS_PER_BATCH; ++i) {
+                JobManager::queue_job({"spawner"_hash, spawning_job, &batch_counter});
+            }
+            wait_for_batch();
+        });
+        // Every pass touches the whole buffer from all workers, pieces landing on different
+        // workers each time.
+        shared_data_bench.run(name, [] {
+            JobManager::parallel_for(shared_data, 4096, [](float& element) {
+                element = element * 0.999f + 0.001f;
+            });
+        });
+        JobManager::shutdown();
+    }
+    report(steal_bench);
+    report(shared_data_bench);
+}
+
+void job_manager_wake_latency() {
+    constexpr std::size_t NUM_SAMPLES = 200;
+
+    JobManager::init();
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(NUM_SAMPLES);
+    for (std::size_t i = 0; i < NUM_SAMPLES; ++i) {
+        // Give every worker enough time to get through spinning and park.
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        job_start_time = 0;
+        const auto queue_time = std::chrono::steady_clock::now();
+        JobManager::queue_job({"timestamp"_hash, timestamp_job});
+        while (job_start_time.load() == 0) {
+            // Don't starve the worker we just woke on machines with few cores.
+            std::this_thread::yield();
+        }
+        const auto start_time = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(job_start_time.load()));
+        samples.push_back(start_time - queue_time);
+    }
+    JobManager::shutdown();
+
+    std::ranges::sort(samples);
+    const auto percentile = [&](std::size_t p) {
+        return samples[std::min(samples.size() * p / 100, samples.size() - 1)];
+    };
+    std::println("\n| JobManager wake latency (parked workers) | min | p50 | p90 | p99 | max |");
+    std::println("|---|---:|---:|---:|---:|---:|");
+    std::println("| queue_job -> job start | {} | {} | {} | {} | {} |", samples.front(), percentile(50), percentile(90), percentile(99), samples.back());
+}
+} // namespace vee::bench
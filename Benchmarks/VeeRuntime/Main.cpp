@@ -0,0 +1,85 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Benchmarks.hpp"
+
+#include <nanobench.h>
+
+#include <cstring>
+#include <fstream>
+#include <print>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+bool collect_json = false;
+// One JSON document per reported Bench, rendered with nanobench's JSON template
+std::vector<std::string> json_reports;
+
+void print_usage() {
+    std::println("Usage: VeeRuntimeBenchmarks [--json <file>]");
+    std::println("  --json <file>  Also write every result to file as JSON, for diffing between runs.");
+}
+} // namespace
+
+void vee::bench::report(const ankerl::nanobench::Bench& bench) {
+    if (!collect_json) {
+        return;
+    }
+    std::ostringstream json;
+    ankerl::nanobench::render(ankerl::nanobench::templates::json(), bench, json);
+    json_reports.push_back(std::move(json).str());
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    collect_json = json_path != nullptr;
+
+    vee::bench::fiber_switch();
+    vee::bench::fiber_create();
+    vee::bench::job_manager_scaling();
+    vee::bench::job_manager_producers();
+    vee::bench::job_manager_fan_out();
+    vee::bench::job_manager_fan_in();
+    vee::bench::job_manager_leaf();
+    vee::bench::job_manager_yield();
+    vee::bench::job_manager_placement();
+    vee::bench::job_manager_wake_latency();
+    vee::bench::job_graph_replay();
+
+    if (json_path != nullptr) {
+        std::ofstream file(json_path);
+        if (!file) {
+            std::println(stderr, "Failed to open {} for writing", json_path);
+            return 1;
+        }
+        // Each report is a complete JSON object, so they can be joined into an array as they are
+        file << "{\"benchmarks\": [\n";
+        for (std::size_t i = 0; i < json_reports.size(); ++i) {
+            file << json_reports[i] << (i + 1 < json_reports.size() ? ",\n" : "\n");
+        }
+        file << "]}\n";
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "FrameMemory.hpp"
+
+#include "LinearAllocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vee {
+namespace {
+// Threads usually need a lot less, but the first frames then don't have to grow it
+constexpr std::size_t SCRATCH_CHUNK_SIZE = 256 * 1024;
+
+std::atomic<uint64_t> current_frame = 0;
+
+struct ThreadScratch {
+    LinearAllocator allocator{SCRATCH_CHUNK_SIZE};
+    // Frame the allocator was last reset for
+    std::atomic<uint64_t> frame = 0;
+    // Copies of the allocator's counters that begin_frame can read from other threads
+    std::atomic<std::size_t> bytes_used = 0;
+    std::atomic<std::size_t> capacity = SCRATCH_CHUNK_SIZE;
+
+    ThreadScratch();
+    ~ThreadScratch();
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadScratch*> threads;
+    FrameMemoryStats last_frame;
+    std::size_t high_water_mark = 0;
+};
+
+/**
+ * Constructed on first use so that it outlives every ThreadScratch
+ */
+Registry& get_registry() {
+    static Registry registry;
+    return registry;
+}
+
+ThreadScratch::ThreadScratch() {
+    Registry& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+    frame.store(current_frame.load(std::memory_order_acquire), std::memory_order_relaxed);
+    registry.threads.push_back(this);
+}
+
+ThreadScratch::~ThreadScratch() {
+    Registry& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+    std::erase(registry.threads, this);
+}
+
+/**
+ * Jobs can move between threads while they're suspended, so the thread_local must not be cached
+ * across calls. Reading it through a function the compiler can't see into guarantees a fresh
+ * lookup.
+ */
+[[gnu::noinline]] ThreadScratch& get_thread_scratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+class FrameMemoryResource final : public std::pmr::memory_resource {
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return FrameMemory::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* /*ptr*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+FrameMemoryResource frame_memory_resource;
+} // namespace
+
+FrameMemoryStats FrameMemory::begin_frame() {
+    Registry& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+    const uint64_t frame = current_frame.load(std::memory_order_relaxed);
+
+    FrameMemoryStats stats;
+    stats.num_threads = registry.threads.size();
+    for (const ThreadScratch* scratch : registry.threads) {
+        stats.capacity += scratch->capacity.load(std::memory_order_relaxed);
+        // Threads that haven't allocated this frame still report the last frame they did
+        if (scratch->frame.load(std::memory_order_relaxed) == frame) {
+            const std::size_t bytes_used = scratch->bytes_used.load(std::memory_order_relaxed);
+            stats.bytes_used += bytes_used;
+            stats.max_thread_bytes_used = std::max(stats.max_thread_bytes_used, bytes_used);
+        }
+    }
+    registry.high_water_mark = std::max(registry.high_water_mark, stats.bytes_used);
+    stats.high_water_mark = registry.high_water_mark;
+    registry.last_frame = stats;
+
+    current_frame.store(frame + 1, std::memory_order_release);
+    return stats;
+}
+
+FrameMemoryStats FrameMemory::last_frame_stats() {
+    Registry& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+    return registry.last_frame;
+}
+
+void* FrameMemory::allocate(std::size_t size, std::size_t alignment) {
+    ThreadScratch& scratch = get_thread_scratch();
+    if (const uint64_t frame = current_frame.load(std::memory_order_acquire); scratch.frame.load(std::memory_order_relaxed) != frame) {
+        scratch.allocator.reset();
+        scratch.bytes_used.store(0, std::memory_order_relaxed);
+        scratch.frame.store(frame, std::memory_order_relaxed);
+    }
+
+    void* ptr = scratch.allocator.allocate(size, alignment);
+    scratch.bytes_used.store(scratch.allocator.bytes_used(), std::memory_order_relaxed);
+    scratch.capacity.store(scratch.allocator.capacity(), std::memory_order_relaxed);
+    return ptr;
+}
+
+std::pmr::memory_resource* FrameMemory::resource() {
+    return &frame_memory_resource;
+}
+} // namespace vee
@@ -0,0 +1,123 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "LinearAllocator.hpp"
+
+#include "Assert.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace vee {
+
+struct LinearAllocator::Chunk {
+    Chunk* next = nullptr;
+    // Usable bytes following the header
+    std::size_t size = 0;
+
+    [[nodiscard]] std::uintptr_t data() const {
+        return reinterpret_cast<std::uintptr_t>(this + 1);
+    }
+};
+
+// Chunks start on a cache line so that allocations from different threads' allocators don't share
+// one.
+constexpr static std::align_val_t CHUNK_ALIGNMENT{64};
+
+static std::uintptr_t align_up(std::uintptr_t address, std::size_t alignment) {
+    return (address + alignment - 1) & ~(alignment - 1);
+}
+
+LinearAllocator::LinearAllocator(std::size_t chunk_size)
+    : chunk_size_(chunk_size) {
+    VASSERT(chunk_size > 0, "LinearAllocator chunk size must not be zero");
+    current_ = add_chunk(chunk_size);
+}
+
+LinearAllocator::~LinearAllocator() {
+    free_chunks();
+}
+
+void* LinearAllocator::allocate(std::size_t size, std::size_t alignment) {
+    VASSERT(std::has_single_bit(alignment), "Alignment {} is not a power of two", alignment);
+
+    std::uintptr_t begin = align_up(current_->data() + offset_, alignment);
+    if (begin + size > current_->data() + current_->size) {
+        // Move on to the next chunk, reusing one that is left over from a rewind if it's big enough
+        const std::size_t worst_case_size = size + alignment - 1;
+        Chunk* next = current_->next;
+        if (next == nullptr || next->size < worst_case_size) {
+            next = add_chunk(worst_case_size);
+        }
+        previous_chunks_used_ += offset_;
+        current_ = next;
+        offset_ = 0;
+        begin = align_up(current_->data(), alignment);
+    }
+
+    offset_ = begin + size - current_->data();
+    high_water_mark_ = std::max(high_water_mark_, bytes_used());
+    return reinterpret_cast<void*>(begin);
+}
+
+LinearAllocator::Marker LinearAllocator::mark() const {
+    return {current_, offset_, previous_chunks_used_};
+}
+
+void LinearAllocator::rewind(const Marker& marker) {
+    VASSERT(marker.chunk != nullptr, "Rewinding a LinearAllocator to an empty marker");
+    current_ = static_cast<Chunk*>(marker.chunk);
+    offset_ = marker.offset;
+    previous_chunks_used_ = marker.previous_chunks_used;
+}
+
+void LinearAllocator::reset() {
+    if (first_->next != nullptr) {
+        // Replace the chunks with one that fits everything, so that the next round needs no more
+        const std::size_t total_size = capacity_;
+        free_chunks();
+        current_ = add_chunk(total_size);
+    }
+    current_ = first_;
+    offset_ = 0;
+    previous_chunks_used_ = 0;
+}
+
+LinearAllocator::Chunk* LinearAllocator::add_chunk(std::size_t min_size) {
+    const std::size_t size = std::max(chunk_size_, min_size);
+    auto* chunk = new (::operator new(sizeof(Chunk) + size, CHUNK_ALIGNMENT)) Chunk{.size = size};
+    if (current_ == nullptr) {
+        first_ = chunk;
+    } else {
+        chunk->next = current_->next;
+        current_->next = chunk;
+    }
+    capacity_ += size;
+    return chunk;
+}
+
+void LinearAllocator::free_chunks() {
+    for (Chunk* chunk = first_; chunk != nullptr;) {
+        Chunk* next = chunk->next;
+        chunk->~Chunk();
+        ::operator delete(chunk, CHUNK_ALIGNMENT);
+        chunk = next;
+    }
+    first_ = nullptr;
+    current_ = nullptr;
+    capacity_ = 0;
+}
+} // namespace vee
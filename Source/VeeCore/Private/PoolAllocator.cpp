@@ -0,0 +1,99 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "PoolAllocator.hpp"
+
+#include "Assert.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace vee {
+
+struct PoolAllocator::Chunk {
+    Chunk* next;
+};
+
+static std::size_t round_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+PoolAllocator::PoolAllocator(std::size_t block_size, std::size_t block_alignment, std::size_t blocks_per_chunk)
+    : block_alignment_(std::max(block_alignment, alignof(FreeBlock)))
+    , blocks_per_chunk_(blocks_per_chunk) {
+    VASSERT(std::has_single_bit(block_alignment), "Alignment {} is not a power of two", block_alignment);
+    VASSERT(blocks_per_chunk > 0, "PoolAllocator needs at least one block per chunk");
+    // Consecutive blocks must all be aligned, and free ones hold the free list link
+    block_size_ = round_up(std::max(block_size, sizeof(FreeBlock)), block_alignment_);
+}
+
+PoolAllocator::~PoolAllocator() {
+    VASSERT(num_allocated_ == 0, "PoolAllocator destroyed with {} blocks still allocated", num_allocated_);
+    const std::align_val_t chunk_alignment{std::max(block_alignment_, alignof(Chunk))};
+    for (Chunk* chunk = chunks_; chunk != nullptr;) {
+        Chunk* next = chunk->next;
+        ::operator delete(chunk, chunk_alignment);
+        chunk = next;
+    }
+}
+
+void* PoolAllocator::allocate() {
+    if (free_list_ == nullptr) {
+        add_chunk();
+    }
+    FreeBlock* block = free_list_;
+    free_list_ = block->next;
+    ++num_allocated_;
+    high_water_mark_ = std::max(high_water_mark_, num_allocated_);
+    return block;
+}
+
+void* PoolAllocator::allocate(std::size_t size, std::size_t alignment) {
+    VASSERT(size <= block_size_ && alignment <= block_alignment_, "Allocation of {} bytes aligned to {} doesn't fit in a {} byte pool block", size, alignment, block_size_);
+    return allocate();
+}
+
+void PoolAllocator::deallocate(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = free_list_;
+    free_list_ = block;
+    --num_allocated_;
+}
+
+void PoolAllocator::deallocate(void* ptr, std::size_t /*size*/, std::size_t /*alignment*/) {
+    deallocate(ptr);
+}
+
+void PoolAllocator::add_chunk() {
+    const std::size_t header_size = round_up(sizeof(Chunk), block_alignment_);
+    const std::align_val_t chunk_alignment{std::max(block_alignment_, alignof(Chunk))};
+    auto* chunk = static_cast<Chunk*>(::operator new(header_size + block_size_ * blocks_per_chunk_, chunk_alignment));
+    chunk->next = chunks_;
+    chunks_ = chunk;
+    capacity_ += blocks_per_chunk_;
+
+    // Link the blocks back to front so that they're handed out in address order
+    auto* blocks = reinterpret_cast<std::byte*>(chunk) + header_size;
+    for (std::size_t i = blocks_per_chunk_; i > 0; --i) {
+        auto* block = reinterpret_cast<FreeBlock*>(blocks + (i - 1) * block_size_);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+}
+} // namespace vee
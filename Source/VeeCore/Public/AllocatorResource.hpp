@@ -0,0 +1,66 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memory_resource>
+
+namespace vee {
+
+template <typename T>
+concept Allocator = requires(T& allocator, void* ptr, std::size_t size, std::size_t alignment) {
+    { allocator.allocate(size, alignment) } -> std::same_as<void*>;
+    { allocator.deallocate(ptr, size, alignment) };
+};
+
+/**
+ * Exposes one of our allocators as a std::pmr::memory_resource, so that std::pmr containers can
+ * use it. The resource doesn't own the allocator, and is no more thread-safe than it.
+ *
+ * @code
+ * LinearAllocator scratch;
+ * AllocatorResource resource(scratch);
+ * std::pmr::vector<int> values(&resource);
+ * @endcode
+ */
+template <Allocator A>
+class AllocatorResource final : public std::pmr::memory_resource {
+public:
+    explicit AllocatorResource(A& allocator)
+        : allocator_(&allocator) {}
+
+    [[nodiscard]] A& allocator() const {
+        return *allocator_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return allocator_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        allocator_->deallocate(ptr, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        const auto* other_resource = dynamic_cast<const AllocatorResource*>(&other);
+        return other_resource != nullptr && other_resource->allocator_ == allocator_;
+    }
+
+    A* allocator_;
+};
+} // namespace vee
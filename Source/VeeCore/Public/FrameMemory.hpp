@@ -0,0 +1,84 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace vee {
+
+struct FrameMemoryStats {
+    /**
+     * Scratch bytes used during the frame, summed over all threads.
+     */
+    std::size_t bytes_used = 0;
+    /**
+     * Most scratch bytes used by a single thread during the frame.
+     */
+    std::size_t max_thread_bytes_used = 0;
+    /**
+     * The largest bytes_used of any frame so far.
+     */
+    std::size_t high_water_mark = 0;
+    /**
+     * Scratch memory reserved by all threads.
+     */
+    std::size_t capacity = 0;
+    std::size_t num_threads = 0;
+};
+
+/**
+ * Scratch memory that lives until the end of the frame. Every thread allocates from its own
+ * LinearAllocator, which resets itself the first time it's used in a new frame, so allocating
+ * takes no locks and stops touching the heap once the allocators have grown to fit a frame.
+ *
+ * Memory is only valid until the next begin_frame, so jobs must not hold on to it across frames.
+ * Freeing it is never required.
+ */
+namespace FrameMemory {
+    /**
+     * End the current frame and start the next one. Call once per frame, from one thread.
+     * @return Scratch memory usage of the frame that just ended. Allocations racing the call may be
+     * counted towards either frame.
+     */
+    FrameMemoryStats begin_frame();
+    /**
+     * @return Usage of the last frame that ended, see begin_frame.
+     */
+    FrameMemoryStats last_frame_stats();
+
+    /**
+     * @param alignment Must be a power of two.
+     * @return Uninitialized memory that stays valid until the end of the frame.
+     */
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @return Uninitialized storage for count objects of type T.
+     */
+    template <typename T>
+    [[nodiscard]] T* allocate(std::size_t count = 1) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @return A memory resource that allocates frame scratch memory for the calling thread, for
+     * std::pmr containers that only live for the frame. Containers may be shared between
+     * threads, each allocation is served by whichever thread makes it.
+     */
+    std::pmr::memory_resource* resource();
+} // namespace FrameMemory
+} // namespace vee
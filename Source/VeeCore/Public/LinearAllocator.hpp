@@ -0,0 +1,124 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace vee {
+
+/**
+ * Bump allocator for short-lived scratch memory. Allocating is a pointer increment, individual
+ * deallocations are ignored and everything is freed at once by reset or rewind.
+ *
+ * Memory comes from chunks that are kept across resets. When a chunk runs out, another one is
+ * chained on, and the next reset replaces them all with a single chunk big enough for the lot. A
+ * steady workload stops touching the heap after its first few resets.
+ *
+ * Not thread-safe.
+ */
+class LinearAllocator {
+public:
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * Position in the allocator to rewind to, see mark().
+     */
+    struct Marker {
+        void* chunk = nullptr;
+        std::size_t offset = 0;
+        std::size_t previous_chunks_used = 0;
+    };
+
+    /**
+     * @param chunk_size Size of the first chunk, and the minimum size of chunks added later.
+     */
+    explicit LinearAllocator(std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+    ~LinearAllocator();
+
+    LinearAllocator(const LinearAllocator&) = delete;
+    LinearAllocator& operator=(const LinearAllocator&) = delete;
+    LinearAllocator(LinearAllocator&&) = delete;
+    LinearAllocator& operator=(LinearAllocator&&) = delete;
+
+    /**
+     * @param alignment Must be a power of two.
+     * @return Uninitialized memory that stays valid until the next reset, or a rewind to before it.
+     */
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @return Uninitialized storage for count objects of type T.
+     */
+    template <typename T>
+    [[nodiscard]] T* allocate(std::size_t count = 1) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Does nothing, memory is only reclaimed by reset and rewind.
+     */
+    void deallocate(void* /*ptr*/, std::size_t /*size*/, std::size_t /*alignment*/) {}
+
+    /**
+     * @return The current position, to free everything allocated after it with rewind.
+     */
+    [[nodiscard]] Marker mark() const;
+    /**
+     * Free everything allocated since marker was taken. Chunks added in the meantime are kept for
+     * reuse.
+     */
+    void rewind(const Marker& marker);
+    /**
+     * Free everything. If more than one chunk was needed, they are merged into one.
+     */
+    void reset();
+
+    /**
+     * @return Bytes handed out since the last reset, including alignment padding.
+     */
+    [[nodiscard]] std::size_t bytes_used() const {
+        return previous_chunks_used_ + offset_;
+    }
+    /**
+     * @return The largest bytes_used() ever reached.
+     */
+    [[nodiscard]] std::size_t high_water_mark() const {
+        return high_water_mark_;
+    }
+    /**
+     * @return Total size of all chunks.
+     */
+    [[nodiscard]] std::size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Chunk;
+
+    Chunk* add_chunk(std::size_t min_size);
+    void free_chunks();
+
+    std::size_t chunk_size_;
+    Chunk* first_ = nullptr;
+    Chunk* current_ = nullptr;
+    std::size_t offset_ = 0;
+    // Bytes used in chunks before current_
+    std::size_t previous_chunks_used_ = 0;
+    std::size_t high_water_mark_ = 0;
+    std::size_t capacity_ = 0;
+};
+} // namespace vee
@@ -32,6 +32,13 @@ enum class LogSeverity {
 };
 void _log_impl(LogSeverity severity, std::string_view msg, const std::source_location& location);
 
+#ifndef VEE_LOG_FILTER_LEVEL
+#define VEE_LOG_FILTER_LEVEL Trace
+#endif
+
+// Messages below this severity are compiled out entirely, arguments aren't even formatted.
+constexpr LogSeverity LOG_FILTER_LEVEL = LogSeverity::VEE_LOG_FILTER_LEVEL;
+
 // (Ab)use implicit constructor to allow us to provide the default value for the source_location,
 // while still accepting variadic arguments in our actual logging functions. When a log function is
 // called, the format string will be coerced to this type.
@@ -68,23 +75,33 @@ struct format_string_with_location<> {
 
 template <typename... Args>
 void log_trace(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
-    fmt.log(LogSeverity::Trace, std::forward<Args>(args)...);
+    if constexpr (LogSeverity::Trace >= LOG_FILTER_LEVEL) {
+        fmt.log(LogSeverity::Trace, std::forward<Args>(args)...);
+    }
 }
 template <typename... Args>
 void log_debug(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
-    fmt.log(LogSeverity::Debug, std::forward<Args>(args)...);
+    if constexpr (LogSeverity::Debug >= LOG_FILTER_LEVEL) {
+        fmt.log(LogSeverity::Debug, std::forward<Args>(args)...);
+    }
 }
 template <typename... Args>
 void log_info(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
-    fmt.log(LogSeverity::Info, std::forward<Args>(args)...);
+    if constexpr (LogSeverity::Info >= LOG_FILTER_LEVEL) {
+        fmt.log(LogSeverity::Info, std::forward<Args>(args)...);
+    }
 }
 template <typename... Args>
 void log_warning(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
-    fmt.log(LogSeverity::Warning, std::forward<Args>(args)...);
+    if constexpr (LogSeverity::Warning >= LOG_FILTER_LEVEL) {
+        fmt.log(LogSeverity::Warning, std::forward<Args>(args)...);
+    }
 }
 template <typename... Args>
 void log_error(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
-    fmt.log(LogSeverity::Error, std::forward<Args>(args)...);
+    if constexpr (LogSeverity::Error >= LOG_FILTER_LEVEL) {
+        fmt.log(LogSeverity::Error, std::forward<Args>(args)...);
+    }
 }
 template <typename... Args>
 [[noreturn]] void log_fatal(format_string_with_location<std::type_identity_t<Args>...> fmt, Args&&... args) {
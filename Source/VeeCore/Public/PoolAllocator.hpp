@@ -0,0 +1,112 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace vee {
+
+/**
+ * Allocator for many objects of the same size. Free blocks are kept in an intrusive free list, so
+ * allocating and deallocating are a couple of pointer moves. Blocks are carved out of chunks that
+ * are only returned to the system when the pool is destroyed.
+ *
+ * Not thread-safe.
+ */
+class PoolAllocator {
+public:
+    /**
+     * @param block_size Size of every allocation. Rounded up to hold at least a pointer.
+     * @param block_alignment Alignment of every allocation. Must be a power of two.
+     * @param blocks_per_chunk Number of blocks allocated from the system at once.
+     */
+    explicit PoolAllocator(std::size_t block_size, std::size_t block_alignment = alignof(std::max_align_t), std::size_t blocks_per_chunk = 64);
+    ~PoolAllocator();
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    PoolAllocator(PoolAllocator&&) = delete;
+    PoolAllocator& operator=(PoolAllocator&&) = delete;
+
+    /**
+     * @return One uninitialized block.
+     */
+    [[nodiscard]] void* allocate();
+    /**
+     * Allocate a block for an object that fits in it, as used by AllocatorResource.
+     */
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment);
+    /**
+     * Return a block to the pool.
+     */
+    void deallocate(void* ptr);
+    void deallocate(void* ptr, std::size_t size, std::size_t alignment);
+
+    template <typename T, typename... Args>
+    [[nodiscard]] T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroy(T* object) {
+        if (object != nullptr) {
+            object->~T();
+            deallocate(object);
+        }
+    }
+
+    [[nodiscard]] std::size_t block_size() const {
+        return block_size_;
+    }
+    /**
+     * @return Blocks currently handed out.
+     */
+    [[nodiscard]] std::size_t num_allocated() const {
+        return num_allocated_;
+    }
+    /**
+     * @return The largest num_allocated() ever reached.
+     */
+    [[nodiscard]] std::size_t high_water_mark() const {
+        return high_water_mark_;
+    }
+    /**
+     * @return Blocks in all chunks, allocated or not.
+     */
+    [[nodiscard]] std::size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct Chunk;
+
+    void add_chunk();
+
+    std::size_t block_size_;
+    std::size_t block_alignment_;
+    std::size_t blocks_per_chunk_;
+    FreeBlock* free_list_ = nullptr;
+    Chunk* chunks_ = nullptr;
+    std::size_t num_allocated_ = 0;
+    std::size_t high_water_mark_ = 0;
+    std::size_t capacity_ = 0;
+};
+} // namespace vee
@@ -25,8 +25,10 @@
 #include <tracy/Tracy.hpp>
 
 vee::rdg::EditorRenderPass::EditorRenderPass() {
-    register_source("render_target"_hash, DirectSource<ImageResource>::make(render_target_));
+    register_source("render_target"_hash, DirectSource<ImageResource>::make(render_target_), ResourceUsage::ColorAttachment);
     register_sink("render_target"_hash, DirectSink<ImageResource>::make(render_target_));
+    // ImGui keeps its state in globals and isn't safe to use from the workers
+    main_thread_only_ = true;
 }
 
 void vee::rdg::EditorRenderPass::execute(vk::CommandBuffer cmd) {
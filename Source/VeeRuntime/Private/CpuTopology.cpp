@@ -0,0 +1,102 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "CpuTopology.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <ranges>
+#include <set>
+#include <span>
+
+namespace vee {
+std::size_t CpuTopology::num_cores() const {
+    std::set<std::size_t> cores;
+    for (const LogicalCpu& cpu : cpus) {
+        cores.insert(cpu.core);
+    }
+    return cores.size();
+}
+
+std::size_t CpuTopology::num_cache_domains() const {
+    std::set<std::size_t> domains;
+    for (const LogicalCpu& cpu : cpus) {
+        domains.insert(cpu.cache_domain);
+    }
+    return domains.size();
+}
+
+/**
+ * Pick the cache domain with the most cores of the highest capacity, or the one with the largest
+ * cache on a tie. On hybrid CPUs this is the domain with the most performance cores. On CPUs with
+ * stacked cache on one CCD it's that CCD.
+ */
+static std::size_t pick_cache_domain(std::span<const LogicalCpu* const> cores, uint32_t max_capacity) {
+    struct DomainScore {
+        std::size_t num_fast_cores = 0;
+        std::size_t cache_size = 0;
+
+        auto operator<=>(const DomainScore&) const = default;
+    };
+
+    std::map<std::size_t, DomainScore> scores;
+    for (const LogicalCpu* core : cores) {
+        DomainScore& score = scores[core->cache_domain];
+        score.num_fast_cores += core->capacity == max_capacity ? 1 : 0;
+        score.cache_size = std::max(score.cache_size, core->cache_size);
+    }
+    // max_element returns the first of equal elements, so ties go to the lowest domain
+    return std::ranges::max_element(scores, {}, [](const auto& entry) { return entry.second; })->first;
+}
+
+WorkerCpus select_worker_cpus(const CpuTopology& topology, WorkerPlacement placement) {
+    WorkerCpus result;
+    if (topology.cpus.empty()) {
+        return result;
+    }
+
+    // One logical CPU per physical core, fastest first. The sibling with the lowest id might not be
+    // available to us, so take the first one that is.
+    std::vector<const LogicalCpu*> cores;
+    std::vector<const LogicalCpu*> siblings;
+    std::set<std::size_t> seen_cores;
+    for (const LogicalCpu& cpu : topology.cpus) {
+        (seen_cores.insert(cpu.core).second ? cores : siblings).push_back(&cpu);
+    }
+    std::ranges::stable_sort(cores, std::greater{}, &LogicalCpu::capacity);
+    const uint32_t max_capacity = cores.front()->capacity;
+
+    if (placement == WorkerPlacement::SharedCache) {
+        const std::size_t domain = pick_cache_domain(cores, max_capacity);
+        // Preferred cores first, keeping both partitions sorted by capacity
+        const auto rest = std::ranges::stable_partition(cores, [&](const LogicalCpu* core) {
+            return core->cache_domain == domain && core->capacity == max_capacity;
+        });
+        result.num_preferred = static_cast<std::size_t>(rest.begin() - cores.begin());
+    } else {
+        result.num_preferred = cores.size();
+    }
+
+    result.cpus.reserve(topology.cpus.size());
+    for (const LogicalCpu* cpu : cores) {
+        result.cpus.push_back(cpu->id);
+    }
+    for (const LogicalCpu* cpu : siblings) {
+        result.cpus.push_back(cpu->id);
+    }
+    return result;
+}
+} // namespace vee
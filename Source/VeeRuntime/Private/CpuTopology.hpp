@@ -0,0 +1,65 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include "JobManager.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vee {
+struct LogicalCpu {
+    // OS index of the CPU, as used in affinity masks
+    std::size_t id = 0;
+    // Lowest id of the logical CPUs on the same physical core
+    std::size_t core = 0;
+    // Lowest id of the logical CPUs sharing the same last level cache
+    std::size_t cache_domain = 0;
+    // Size of the last level cache in bytes, 0 if unknown
+    std::size_t cache_size = 0;
+    // Relative performance of the core. Every core reports the same value unless the CPU mixes
+    // performance and efficiency cores.
+    uint32_t capacity = 1024;
+};
+
+struct CpuTopology {
+    // Logical CPUs this process is allowed to run on, sorted by id
+    std::vector<LogicalCpu> cpus;
+
+    [[nodiscard]] std::size_t num_cores() const;
+    [[nodiscard]] std::size_t num_cache_domains() const;
+};
+
+struct WorkerCpus {
+    // Logical CPUs in the order workers should be placed on them
+    std::vector<std::size_t> cpus;
+    // Number of leading entries in cpus that were picked by the placement policy. This is the
+    // default worker count.
+    std::size_t num_preferred = 0;
+};
+
+/**
+ * Read the CPU topology from the OS. Implemented per platform.
+ */
+CpuTopology probe_cpu_topology();
+
+/**
+ * Order the CPUs of topology for worker placement: the cores picked by placement, then the
+ * remaining physical cores from fastest to slowest, then SMT siblings.
+ */
+WorkerCpus select_worker_cpus(const CpuTopology& topology, WorkerPlacement placement);
+} // namespace vee
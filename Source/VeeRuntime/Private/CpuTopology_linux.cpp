@@ -0,0 +1,141 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "CpuTopology.hpp"
+
+#include "Logging.hpp"
+
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sched.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vee {
+// Not a std::filesystem::path, so that probing works during static initialization
+constexpr static const char* SYSFS_CPU_PATH = "/sys/devices/system/cpu";
+
+static std::optional<std::string> read_sysfs_line(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line)) {
+        return std::nullopt;
+    }
+    return line;
+}
+
+static std::optional<std::size_t> parse_number(std::string_view text) {
+    std::size_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end == text.data()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * Parse a kernel CPU list such as "0-3,8-11".
+ */
+static std::vector<std::size_t> parse_cpu_list(std::string_view list) {
+    std::vector<std::size_t> cpus;
+    while (!list.empty()) {
+        const std::size_t comma = list.find(',');
+        const std::string_view range = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+        const std::size_t dash = range.find('-');
+        const std::optional<std::size_t> first = parse_number(range.substr(0, dash));
+        const std::optional<std::size_t> last = dash == std::string_view::npos ? first : parse_number(range.substr(dash + 1));
+        if (!first || !last) {
+            continue;
+        }
+        for (std::size_t cpu = *first; cpu <= *last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @return The lowest CPU in the list stored at path, or fallback if it can't be read.
+ */
+static std::size_t first_cpu_in_list(const std::filesystem::path& path, std::size_t fallback) {
+    const std::vector<std::size_t> cpus = parse_cpu_list(read_sysfs_line(path).value_or(""));
+    return cpus.empty() ? fallback : std::ranges::min(cpus);
+}
+
+/**
+ * Find the highest level cache of cpu and record which CPUs share it and how large it is.
+ */
+static void probe_last_level_cache(const std::filesystem::path& cpu_path, LogicalCpu& cpu) {
+    std::size_t best_level = 0;
+    for (std::size_t index = 0;; ++index) {
+        const std::filesystem::path cache_path = cpu_path / "cache" / ("index" + std::to_string(index));
+        const std::optional<std::string> level_text = read_sysfs_line(cache_path / "level");
+        if (!level_text) {
+            break;
+        }
+        const std::size_t level = parse_number(*level_text).value_or(0);
+        if (level <= best_level || read_sysfs_line(cache_path / "type").value_or("") == "Instruction") {
+            continue;
+        }
+
+        best_level = level;
+        cpu.cache_domain = first_cpu_in_list(cache_path / "shared_cpu_list", cpu.id);
+        // Reported as e.g. "32768K"
+        const std::string size_text = read_sysfs_line(cache_path / "size").value_or("");
+        cpu.cache_size = parse_number(size_text).value_or(0) * (size_text.ends_with('K') ? 1024 : size_text.ends_with('M') ? 1024 * 1024 : 1);
+    }
+}
+
+CpuTopology probe_cpu_topology() {
+    CpuTopology topology;
+
+    // Respect the affinity the process was started with, e.g. from taskset or a container cpuset
+    cpu_set_t allowed;
+    const bool has_affinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    for (const std::size_t id : parse_cpu_list(read_sysfs_line(std::filesystem::path(SYSFS_CPU_PATH) / "online").value_or(""))) {
+        if (has_affinity && (id >= CPU_SETSIZE || !CPU_ISSET(id, &allowed))) {
+            continue;
+        }
+
+        const std::filesystem::path cpu_path = std::filesystem::path(SYSFS_CPU_PATH) / ("cpu" + std::to_string(id));
+        LogicalCpu cpu{.id = id};
+        cpu.core = first_cpu_in_list(cpu_path / "topology" / "thread_siblings_list", id);
+        // CPUs without a shared cache are grouped by package instead
+        cpu.cache_domain = first_cpu_in_list(cpu_path / "topology" / "core_siblings_list", 0);
+        probe_last_level_cache(cpu_path, cpu);
+        if (const auto capacity = parse_number(read_sysfs_line(cpu_path / "cpu_capacity").value_or(""))) {
+            cpu.capacity = static_cast<uint32_t>(*capacity);
+        }
+        topology.cpus.push_back(cpu);
+    }
+
+    if (topology.cpus.empty()) {
+        log_warning("Failed to read the CPU topology from {}, treating every CPU as its own core", SYSFS_CPU_PATH);
+        for (std::size_t id = 0; id < std::max(std::thread::hardware_concurrency(), 1u); ++id) {
+            topology.cpus.push_back({.id = id, .core = id});
+        }
+    }
+    return topology;
+}
+} // namespace vee
@@ -0,0 +1,32 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "CpuTopology.hpp"
+
+
+#include <algorithm>
+#include <thread>
+
+namespace vee {
+CpuTopology probe_cpu_topology() {
+    // TODO: Read the real topology with GetLogicalProcessorInformationEx. Until then, keep assuming
+    // a hyper threaded CPU with sibling threads numbered next to each other and a single cache.
+    CpuTopology topology;
+    for (std::size_t id = 0; id < std::max(std::thread::hardware_concurrency(), 1u); ++id) {
+        topology.cpus.push_back({.id = id, .core = id & ~std::size_t{1}});
+    }
+    return topology;
+}
+} // namespace vee
@@ -19,8 +19,10 @@
 #include "Components/SpriteRendererComponent.hpp"
 #include "Engine/Material.hpp"
 #include "Engine/Texture.hpp"
+#include "FrameMemory.hpp"
 #include "GameConfig.hpp"
 #include "JobManager.hpp"
+#include "Platform/Filesystem.hpp"
 #include "Transform.h"
 
 #include <GLFW/glfw3.h>
@@ -35,6 +37,8 @@ namespace vee {
 void Engine::init() {
     ZoneScoped;
     JobManager::init();
+    platform::filesystem::init_async_io();
+    TracyPlotConfig("Frame scratch memory", tracy::PlotFormatType::Memory, true, true, 0);
 
     start_time_ = _glfwPlatformGetTimerValue();
 
@@ -44,6 +48,7 @@ void Engine::init() {
 }
 
 void Engine::shutdown() {
+    platform::filesystem::shutdown_async_io();
     JobManager::shutdown();
 }
 
@@ -54,6 +59,11 @@ void Engine::tick() {
     delta_time_ = static_cast<double>(now - game_time_) / static_cast<double>(_glfwPlatformGetTimerFrequency());
     game_time_ = now;
 
+    [[maybe_unused]] const FrameMemoryStats frame_memory = FrameMemory::begin_frame();
+    TracyPlot("Frame scratch memory", static_cast<int64_t>(frame_memory.bytes_used));
+    JobManager::plot_stats();
+    JobManager::run_main_thread_jobs();
+
     if (g_game_info.game_tick) {
         g_game_info.game_tick();
     }
@@ -43,30 +43,7 @@ void CopyBufferSink::prepare(const RenderGraph&) {
     const uint64_t idx = renderer.get_frame_number() % 3;
 
     target = resources_[idx];
-}
-
-void CopyDestSink::init(RenderCtx& ctx) {
-    for (auto & resource : resource_) {
-        resource = std::make_unique<Image>(
-            ctx.device,
-            ctx.allocator,
-            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
-            vk::Extent3D(DebugScreen::WIDTH, DebugScreen::HEIGHT, 1),
-            vk::Format::eR8G8B8A8Srgb,
-            vk::ImageAspectFlagBits::eColor
-        );
-    }
-    target = std::make_shared<ImageResource>();
-}
-
-void CopyDestSink::prepare(const RenderGraph&) {
-    const Renderer& renderer = entt::locator<IApplication>::value().get_renderer();
-    const uint64_t idx = renderer.get_frame_number() % 3;
-
-    target->image = resource_[idx]->image;
-    target->view = resource_[idx]->view;
-    target->width = resource_[idx]->width();
-    target->height = resource_[idx]->height();
+    buffer_ = std::shared_ptr<Buffer>(target, &target->buf);
 }
 
 vee::rdg::DebugBuffer::~DebugBuffer() {
@@ -74,43 +51,14 @@ vee::rdg::DebugBuffer::~DebugBuffer() {
 }
 
 FrameImageRenderPass::FrameImageRenderPass() {
-    register_source("copy_source"_hash, DirectSource<ImageResource>::make(copy_source_));
-    register_sink("copy_dest"_hash, CopyDestSink::make(copy_dest_));
-    register_sink("copy_buffer"_hash, CopyBufferSink::make(copy_buffer_));
+    register_source("copy_source"_hash, DirectSource<ImageResource>::make(copy_source_), ResourceUsage::TransferSrc);
+    register_source("copy_dest"_hash, DirectSource<ImageResource>::make(copy_dest_), ResourceUsage::TransferDst);
+    register_sink("copy_dest"_hash, DirectSink<ImageResource>::make(copy_dest_));
 }
 
 void FrameImageRenderPass::execute(vk::CommandBuffer cmd) {
     ZoneScoped;
 
-    {
-        const vk::ImageMemoryBarrier2 image_barrier[] = {
-            {vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-             vk::AccessFlagBits2::eColorAttachmentWrite,
-             vk::PipelineStageFlagBits2::eTransfer,
-             vk::AccessFlagBits2::eTransferRead,
-             vk::ImageLayout::eColorAttachmentOptimal,
-             vk::ImageLayout::eTransferSrcOptimal,
-             {},
-             {},
-             copy_source_->image,
-             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}},
-            {vk::PipelineStageFlagBits2::eNone,
-             vk::AccessFlagBits2::eNone,
-             vk::PipelineStageFlagBits2::eTransfer,
-             vk::AccessFlagBits2::eTransferWrite,
-             vk::ImageLayout::eUndefined,
-             vk::ImageLayout::eTransferDstOptimal,
-             {},
-             {},
-             copy_dest_->image,
-             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}}
-        };
-
-        vk::DependencyInfo dependency_info;
-        dependency_info.setImageMemoryBarriers(image_barrier);
-        cmd.pipelineBarrier2(dependency_info);
-    }
-
     // For Tracy, we need to save a copy of the framebuffer to the CPU. However, it needs to be
     // downscaled for better transfer performance, so we will need to blit to an intermediate
     // image to copy from
@@ -125,42 +73,24 @@ void FrameImageRenderPass::execute(vk::CommandBuffer cmd) {
         copy_source_->image, vk::ImageLayout::eTransferSrcOptimal, copy_dest_->image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eNearest
     );
     cmd.blitImage2(info);
-    {
-        const vk::ImageMemoryBarrier2 image_barrier[] = {
-            {vk::PipelineStageFlagBits2::eTransfer,
-             vk::AccessFlagBits2::eTransferRead,
-             vk::PipelineStageFlagBits2::eAllCommands,
-             vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eColorAttachmentRead,
-             vk::ImageLayout::eTransferSrcOptimal,
-             vk::ImageLayout::eColorAttachmentOptimal,
-             {},
-             {},
-             copy_source_->image,
-             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}},
-            {vk::PipelineStageFlagBits2::eTransfer,
-             vk::AccessFlagBits2::eTransferWrite,
-             vk::PipelineStageFlagBits2::eTransfer,
-             vk::AccessFlagBits2::eTransferRead,
-             vk::ImageLayout::eTransferDstOptimal,
-             vk::ImageLayout::eTransferSrcOptimal,
-             {},
-             {},
-             copy_dest_->image,
-             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}}
-        };
+}
 
-        vk::DependencyInfo dependency_info;
-        dependency_info.setImageMemoryBarriers(image_barrier);
-        cmd.pipelineBarrier2(dependency_info);
-    }
+FrameImageReadbackPass::FrameImageReadbackPass() {
+    register_source("copy_source"_hash, DirectSource<ImageResource>::make(copy_source_), ResourceUsage::TransferSrc);
+    register_sink("copy_buffer"_hash, CopyBufferSink::make(copy_buffer_), ResourceUsage::TransferDst);
+}
+
+void FrameImageReadbackPass::execute(vk::CommandBuffer cmd) {
+    ZoneScoped;
 
     cmd.copyImageToBuffer(
-        copy_dest_->image,
+        copy_source_->image,
         vk::ImageLayout::eTransferSrcOptimal,
         copy_buffer_->buf.buffer,
         vk::BufferImageCopy(0, DebugScreen::WIDTH, DebugScreen::HEIGHT, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {0, 0, 0}, {DebugScreen::WIDTH, DebugScreen::HEIGHT, 1})
     );
 
+    // The buffer is read on the host once the frame is done, outside of the RenderGraph
     {
         const vk::BufferMemoryBarrier2 buffer_barrier = {
             vk::PipelineStageFlagBits2::eTransfer,
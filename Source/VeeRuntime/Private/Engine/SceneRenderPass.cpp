@@ -26,7 +26,9 @@
 #include "RenderGraph/Sink.hpp"
 #include "Transform.h"
 
+#include <algorithm>
 #include <entt/locator/locator.hpp>
+#include <span>
 #include <tracy/Tracy.hpp>
 
 #ifdef VEE_WITH_EDITOR
@@ -35,13 +37,13 @@
 
 namespace vee::rdg {
 SceneRenderPass::SceneRenderPass() {
-    register_source("render_target"_hash, DirectSource<ImageResource>::make(render_target_));
+    register_source("render_target"_hash, DirectSource<ImageResource>::make(render_target_), ResourceUsage::ColorAttachment);
     register_source("vertex_buffer"_hash, DirectSource<Buffer>::make(vertex_buffer_));
     register_source("index_buffer"_hash, DirectSource<Buffer>::make(index_buffer_));
     register_sink("render_target"_hash, DirectSink<ImageResource>::make(render_target_));
 }
 
-void SceneRenderPass::execute(vk::CommandBuffer cmd) {
+std::size_t SceneRenderPass::prepare_chunks() {
     ZoneScoped;
 
     Engine& engine = entt::locator<IApplication>::value().get_engine();
@@ -49,45 +51,72 @@ void SceneRenderPass::execute(vk::CommandBuffer cmd) {
     // TODO: deal with multiple cameras
     auto cams = engine.get_world().entt_registry.view<vee::CameraComponent, vee::Transform>();
     auto [e, cam, cam_transform] = *cams.each().begin();
+    view_projection_ = cam.calculate_view_projection(cam_transform);
+
+    // The registry may change while the workers record, so everything they need is copied out here
+    draws_.clear();
+    auto view = engine.get_world().entt_registry.view<vee::Transform, vee::SpriteRendererComponent>();
+    for (const auto [ent, trans, spr] : view.each()) {
+        const std::shared_ptr<Material>& mat = spr.sprite_.material_;
+        VASSERT(mat != nullptr);
+        draws_.push_back({mat.get(), trans.to_mat()});
+    }
+
+    update_rendering_info();
+    return std::max<std::size_t>(1, (draws_.size() + SPRITES_PER_CHUNK - 1) / SPRITES_PER_CHUNK);
+}
+
+ChunkedRendering SceneRenderPass::chunk_rendering() {
+    return {rendering_info_, {&color_format_, 1}};
+}
 
-    const glm::mat4x4 proj = cam.calculate_view_projection(cam_transform);
+void SceneRenderPass::execute(vk::CommandBuffer cmd) {
+    ZoneScoped;
+
+    cmd.beginRendering(rendering_info_);
+    record_draws(cmd, 0, draws_.size());
+    cmd.endRendering();
+}
 
-    vk::ClearValue clear_value({0.3f, 0.77f, 0.5f, 1.0f});
-    vk::RenderingAttachmentInfo render_attachment = {
+void SceneRenderPass::execute_chunk(vk::CommandBuffer cmd, std::size_t chunk, std::size_t num_chunks) {
+    ZoneScoped;
+
+    const std::size_t chunk_size = (draws_.size() + num_chunks - 1) / num_chunks;
+    const std::size_t begin = std::min(chunk * chunk_size, draws_.size());
+    record_draws(cmd, begin, std::min(begin + chunk_size, draws_.size()));
+}
+
+void SceneRenderPass::update_rendering_info() {
+    const vk::ClearValue clear_value({0.3f, 0.77f, 0.5f, 1.0f});
+    color_format_ = render_target_->format;
+    color_attachment_ = vk::RenderingAttachmentInfo{
         render_target_->view, vk::ImageLayout::eColorAttachmentOptimal, {}, {}, {}, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, clear_value
     };
-    vk::RenderingInfo render_info = {{}, {{}, {render_target_->width, render_target_->height}}, 1, 0, render_attachment, {}, {}};
-
-    cmd.beginRendering(render_info);
-    {
-        const vk::Rect2D scissor({}, {render_target_->width, render_target_->height});
-        const vk::Viewport viewport(
-            0, 0, static_cast<float>(render_target_->width), static_cast<float>(render_target_->height), 1.0f
-        );
-
-        cmd.setScissor(0, scissor);
-        cmd.setViewport(0, viewport);
-
-        auto view = engine.get_world().entt_registry.view<vee::Transform, vee::SpriteRendererComponent>(
-        );
-        for (const auto [ent, trans, spr] : view.each()) {
-            std::shared_ptr<Material>& mat = spr.sprite_.material_;
-            VASSERT(mat != nullptr);
-
-            // Push view projection matrix
-            // TODO: this should go in a buffer
-            cmd.pushConstants(mat->pipeline_.layout, vk::ShaderStageFlagBits::eVertex, sizeof(glm::mat4x4), sizeof(glm::mat4x4), &proj);
-
-            cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, mat->pipeline_.pipeline);
-
-            glm::mat4x4 local_to_world = trans.to_mat();
-            cmd.pushConstants(mat->pipeline_.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4x4), &local_to_world);
-            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mat->pipeline_.layout, 0, mat->descriptor_set_, {});
-            cmd.bindVertexBuffers(0, vertex_buffer_->buffer, {0});
-            cmd.bindIndexBuffer(index_buffer_->buffer, 0, vk::IndexType::eUint16);
-            cmd.drawIndexed(4, 1, 3, 0, 0);
-        }
+    rendering_info_ = vk::RenderingInfo{{}, {{}, {render_target_->width, render_target_->height}}, 1, 0, color_attachment_, {}, {}};
+}
+
+void SceneRenderPass::record_draws(vk::CommandBuffer cmd, std::size_t begin, std::size_t end) const {
+    // Dynamic state isn't inherited by secondary command buffers, every chunk sets its own
+    const vk::Rect2D scissor({}, {render_target_->width, render_target_->height});
+    const vk::Viewport viewport(0, 0, static_cast<float>(render_target_->width), static_cast<float>(render_target_->height), 1.0f);
+
+    cmd.setScissor(0, scissor);
+    cmd.setViewport(0, viewport);
+
+    for (const SpriteDraw& draw : std::span(draws_).subspan(begin, end - begin)) {
+        const Material& mat = *draw.material;
+
+        // Push view projection matrix
+        // TODO: this should go in a buffer
+        cmd.pushConstants(mat.pipeline_.layout, vk::ShaderStageFlagBits::eVertex, sizeof(glm::mat4x4), sizeof(glm::mat4x4), &view_projection_);
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, mat.pipeline_.pipeline);
+
+        cmd.pushConstants(mat.pipeline_.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4x4), &draw.local_to_world);
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mat.pipeline_.layout, 0, mat.descriptor_set_, {});
+        cmd.bindVertexBuffers(0, vertex_buffer_->buffer, {0});
+        cmd.bindIndexBuffer(index_buffer_->buffer, 0, vk::IndexType::eUint16);
+        cmd.drawIndexed(4, 1, 3, 0, 0);
     }
-    cmd.endRendering();
 }
-} // namespace vee::rdg
\ No newline at end of file
+} // namespace vee::rdg
@@ -18,6 +18,7 @@
 #include "IApplication.hpp"
 #include "Logging.hpp"
 #include "MakeSharedEnabler.hpp"
+#include "Platform/Filesystem.hpp"
 #include "Renderer.hpp"
 #include "Renderer/Image.hpp"
 #include "Renderer/RenderCtx.hpp"
@@ -27,8 +28,16 @@
 #include <stb_image.h>
 
 std::expected<std::shared_ptr<vee::Texture>, vee::Texture::CreateError> vee::Texture::create(const char* path, vk::Format format) {
+    // Inside a job this suspends the job instead of blocking the worker while the file is read
+    const std::optional<std::vector<std::byte>> file = platform::filesystem::read_binary_file_async(path);
+    if (!file) {
+        return std::unexpected(CreateError());
+    }
+    const auto* file_data = reinterpret_cast<const stbi_uc*>(file->data());
+    const auto file_size = static_cast<int32_t>(file->size());
+
     uint32_t width, height, channels;
-    if (!stbi_info(path, reinterpret_cast<int32_t*>(&width), reinterpret_cast<int32_t*>(&height), reinterpret_cast<int32_t*>(&channels))) {
+    if (!stbi_info_from_memory(file_data, file_size, reinterpret_cast<int32_t*>(&width), reinterpret_cast<int32_t*>(&height), reinterpret_cast<int32_t*>(&channels))) {
         log_error("Unsupported texture format for \"{}\"\n{}", path, stbi_failure_reason());
         return std::unexpected(CreateError());
     }
@@ -41,7 +50,7 @@ std::expected<std::shared_ptr<vee::Texture>, vee::Texture::CreateError> vee::Tex
     std::shared_ptr<Texture> new_texture = nullptr;
     {
         auto data = std::unique_ptr<uint8_t, void (*)(void*)>(
-            stbi_load(path, reinterpret_cast<int32_t*>(&width), reinterpret_cast<int32_t*>(&height), nullptr, STBI_rgb_alpha), stbi_image_free
+            stbi_load_from_memory(file_data, file_size, reinterpret_cast<int32_t*>(&width), reinterpret_cast<int32_t*>(&height), nullptr, STBI_rgb_alpha), stbi_image_free
         );
         if (data == nullptr) {
             log_error("Failed to load texture from file \"{}\"\n{}", path, stbi_failure_reason());
@@ -0,0 +1,203 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "FiberSync.hpp"
+
+#include "JobScheduler.hpp"
+
+#include <immintrin.h>
+#include <thread>
+
+namespace vee {
+// Number of attempts to take a contended mutex or semaphore before suspending the job
+constexpr static uint32_t SPIN_ATTEMPTS = 64;
+
+// The waiter count is incremented before a parking job makes its last attempt, and the resource is
+// released before a releasing thread checks the waiter count. Both sides use seq_cst, so either the
+// parking job gets the resource or the releasing thread sees the waiter. The wait list lock covers
+// everything between incrementing the count and pushing the job.
+
+void FiberMutex::lock() {
+    for (uint32_t i = 0; i < SPIN_ATTEMPTS; ++i) {
+        if (try_lock()) {
+            return;
+        }
+        _mm_pause();
+    }
+
+    if (!JobManager::in_job()) {
+        while (!try_lock()) {
+            std::this_thread::yield();
+        }
+        return;
+    }
+    // When the job resumes it already owns the mutex, see unlock()
+    JobManager::park(&FiberMutex::park, this);
+}
+
+bool FiberMutex::try_lock() {
+    return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_seq_cst);
+}
+
+void FiberMutex::unlock() {
+    locked_.store(false, std::memory_order_seq_cst);
+    if (waiters_.num_waiters.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    // Take the lock on behalf of the longest waiting job. If somebody else grabbed it first, they
+    // hand it over when they unlock instead.
+    waiters_.lock();
+    Job* job = nullptr;
+    if (waiters_.num_waiters.load(std::memory_order_relaxed) > 0 && try_lock()) {
+        job = waiters_.pop();
+        waiters_.num_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    waiters_.unlock();
+
+    if (job != nullptr) {
+        JobManager::ready_job(job);
+    }
+}
+
+bool FiberMutex::park(Job* job, void* mutex) {
+    FiberMutex& self = *static_cast<FiberMutex*>(mutex);
+    self.waiters_.lock();
+    self.waiters_.num_waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (self.try_lock()) {
+        self.waiters_.num_waiters.fetch_sub(1, std::memory_order_relaxed);
+        self.waiters_.unlock();
+        return false;
+    }
+    self.waiters_.push(job);
+    self.waiters_.unlock();
+    return true;
+}
+
+void FiberSemaphore::acquire() {
+    for (uint32_t i = 0; i < SPIN_ATTEMPTS; ++i) {
+        if (try_acquire()) {
+            return;
+        }
+        _mm_pause();
+    }
+
+    if (!JobManager::in_job()) {
+        while (!try_acquire()) {
+            std::this_thread::yield();
+        }
+        return;
+    }
+    // When the job resumes it already holds a count, see release()
+    JobManager::park(&FiberSemaphore::park, this);
+}
+
+bool FiberSemaphore::try_acquire() {
+    uint32_t count = count_.load(std::memory_order_relaxed);
+    while (count > 0) {
+        if (count_.compare_exchange_weak(count, count - 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FiberSemaphore::release(uint32_t count) {
+    count_.fetch_add(count, std::memory_order_seq_cst);
+
+    // Hand out counts to waiting jobs one at a time, so the wait list isn't locked while jobs are
+    // being queued.
+    while (waiters_.num_waiters.load(std::memory_order_seq_cst) > 0) {
+        waiters_.lock();
+        Job* job = nullptr;
+        if (waiters_.num_waiters.load(std::memory_order_relaxed) > 0 && try_acquire()) {
+            job = waiters_.pop();
+            waiters_.num_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        waiters_.unlock();
+
+        if (job == nullptr) {
+            return;
+        }
+        JobManager::ready_job(job);
+    }
+}
+
+bool FiberSemaphore::park(Job* job, void* semaphore) {
+    FiberSemaphore& self = *static_cast<FiberSemaphore*>(semaphore);
+    self.waiters_.lock();
+    self.waiters_.num_waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (self.try_acquire()) {
+        self.waiters_.num_waiters.fetch_sub(1, std::memory_order_relaxed);
+        self.waiters_.unlock();
+        return false;
+    }
+    self.waiters_.push(job);
+    self.waiters_.unlock();
+    return true;
+}
+
+void FiberConditionVariable::wait(FiberMutex& mutex) {
+    if (!JobManager::in_job()) {
+        // Nothing to park, wake up spuriously instead
+        mutex.unlock();
+        std::this_thread::yield();
+        mutex.lock();
+        return;
+    }
+
+    // The job is on the wait list before the mutex is released, so a notification sent while
+    // holding the mutex can't be missed.
+    ParkContext context{this, &mutex};
+    JobManager::park(&FiberConditionVariable::park, &context);
+    mutex.lock();
+}
+
+void FiberConditionVariable::notify_one() {
+    if (waiters_.num_waiters.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    waiters_.lock();
+    Job* job = waiters_.pop();
+    if (job != nullptr) {
+        waiters_.num_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    waiters_.unlock();
+
+    if (job != nullptr) {
+        JobManager::ready_job(job);
+    }
+}
+
+void FiberConditionVariable::notify_all() {
+    // Only wake the jobs that are waiting now. Woken jobs that wait again stay asleep.
+    for (uint32_t remaining = waiters_.num_waiters.load(std::memory_order_relaxed); remaining > 0; --remaining) {
+        notify_one();
+    }
+}
+
+bool FiberConditionVariable::park(Job* job, void* context) {
+    const ParkContext& park_context = *static_cast<ParkContext*>(context);
+    FiberConditionVariable& self = *park_context.condition;
+    self.waiters_.lock();
+    self.waiters_.num_waiters.fetch_add(1, std::memory_order_relaxed);
+    self.waiters_.push(job);
+    self.waiters_.unlock();
+
+    park_context.mutex->unlock();
+    return true;
+}
+} // namespace vee
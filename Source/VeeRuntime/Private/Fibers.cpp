@@ -17,11 +17,13 @@
 #include "Assert.hpp"
 #include "Logging.hpp"
 
+#include <algorithm>
 #include <string>
 #include <thread>
 #include <tracy/Tracy.hpp>
 
-constexpr static std::size_t FIBER_STACK_SIZE = 1024 * 512;
+// Stack painting fill, chosen to be unlikely to show up as a real value
+constexpr static uint64_t STACK_PAINT = 0xCDCDCDCDCDCDCDCD;
 
 extern "C" uintptr_t _vee_read_rsp();
 asm(R"(
@@ -33,6 +35,8 @@ _vee_read_rsp:
 namespace vee {
 
 extern void fiber_context_switch(FiberContext* from, const FiberContext* to);
+extern void* allocate_fiber_stack(std::size_t size);
+extern void free_fiber_stack(void* stack, std::size_t size);
 
 thread_local Fiber* t_current_fiber;
 Fiber* current_fiber() {
@@ -42,16 +46,7 @@ Fiber* current_fiber() {
             || t_current_fiber->stack == nullptr // FIXME: Right now fibers created from a thread
                                                  // have a null stackptr in the Fiber struct
             || (_vee_read_rsp() >= (uintptr_t)t_current_fiber->stack
-                && _vee_read_rsp() < (uintptr_t)t_current_fiber->stack + FIBER_STACK_SIZE), // FIXME:
-                                                                                            // The
-                                                                                            // stack
-                                                                                            // size
-                                                                                            // shouldn't
-                                                                                            // just
-                                                                                            // be a
-                                                                                            // magic
-                                                                                            // number
-                                                                                            // here.
+                && _vee_read_rsp() < (uintptr_t)t_current_fiber->stack + t_current_fiber->stack_size),
         "The current execution context's stack pointer does not belong to t_current_fiber.\nt_current_fiber->stack: 0x{:X}\n%rsp: 0x{:X}",
         (uintptr_t)t_current_fiber->stack,
         _vee_read_rsp()
@@ -67,29 +62,56 @@ void switch_to_fiber(Fiber& destination) {
     fiber_context_switch(&from->context, &destination.context);
 }
 
-Fiber create_fiber(void (*entry)(), Name name) {
-    void* stack = malloc(FIBER_STACK_SIZE);
+Fiber create_fiber(void (*entry)(), Name name, std::size_t stack_size) {
+    VASSERT(stack_size > 0, "Invalid fiber stack size {}", stack_size);
+    void* stack = allocate_fiber_stack(stack_size);
 
-    const auto stack_top = reinterpret_cast<uintptr_t*>(static_cast<std::byte*>(stack) + FIBER_STACK_SIZE);
+    const auto stack_top = reinterpret_cast<uintptr_t*>(static_cast<std::byte*>(stack) + stack_size);
 
     FiberContext ctx = {};
     ctx.rip = std::bit_cast<uintptr_t>(entry);
     ctx.rsp = std::bit_cast<uintptr_t>(&stack_top[-1]);
-    return {name, stack, ctx};
+    return {name, stack, stack_size, ctx};
 }
 
 void destroy_fiber(Fiber& fiber) {
     if (fiber.stack != nullptr) {
-        free(fiber.stack);
+        free_fiber_stack(fiber.stack, fiber.stack_size);
         fiber.stack = nullptr;
+        fiber.stack_size = 0;
     }
 }
 
+void paint_fiber_stack(Fiber& fiber, std::size_t dirty_bytes) {
+    VASSERT(fiber.stack != nullptr, "Only fibers with a stack of their own can be painted");
+    VASSERT(&fiber != t_current_fiber, "Attempted to paint the stack of the running fiber");
+
+    // Everything below the saved stack pointer is dead while the fiber is suspended
+    auto* const bottom = static_cast<uint64_t*>(fiber.stack);
+    auto* const end = reinterpret_cast<uint64_t*>(fiber.context.rsp & ~uintptr_t{7});
+    auto* const begin = bottom + (fiber.stack_size - std::min(dirty_bytes, fiber.stack_size)) / sizeof(uint64_t);
+    if (begin < end) {
+        std::fill(begin, end, STACK_PAINT);
+    }
+}
+
+std::size_t fiber_stack_high_water_mark(const Fiber& fiber) {
+    VASSERT(fiber.stack != nullptr, "Only fibers with a stack of their own can be painted");
+
+    const auto* const words = static_cast<const uint64_t*>(fiber.stack);
+    const std::size_t num_words = fiber.stack_size / sizeof(uint64_t);
+    std::size_t num_painted = 0;
+    while (num_painted < num_words && words[num_painted] == STACK_PAINT) {
+        ++num_painted;
+    }
+    return (num_words - num_painted) * sizeof(uint64_t);
+}
+
 void convert_thread_to_fiber(Fiber& fiber) {
     VASSERT(current_fiber() == nullptr, "Thread has already been converted to a fiber");
     VASSERT(fiber.stack == nullptr, "A thread cannot be converted to an existing fiber");
     t_current_fiber = &fiber;
-    fiber.name = StrHash(std::to_string(std::this_thread::get_id()._Get_underlying_id()).c_str());
+    fiber.name = StrHash(std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())).c_str());
     TracyFiberEnter(fiber.name.to_string().data());
 }
 
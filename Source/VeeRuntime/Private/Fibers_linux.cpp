@@ -0,0 +1,53 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Assert.hpp"
+#include "Logging.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace vee {
+static std::size_t page_size() {
+    static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+void* allocate_fiber_stack(std::size_t size) {
+    VASSERT(size % page_size() == 0, "Fiber stack size {} is not a multiple of the page size {}", size, page_size());
+    // Reserve one extra page below the stack and make it inaccessible so that an overflow faults
+    // instead of silently corrupting whatever is mapped next to it.
+    const std::size_t guard_size = page_size();
+    void* mapping =
+        mmap(nullptr, size + guard_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED) {
+        log_fatal("Failed to map fiber stack of size {}: {}", size, std::strerror(errno));
+    }
+    if (mprotect(mapping, guard_size, PROT_NONE) != 0) {
+        log_fatal("Failed to protect fiber stack guard page: {}", std::strerror(errno));
+    }
+    return static_cast<std::byte*>(mapping) + guard_size;
+}
+
+void free_fiber_stack(void* stack, std::size_t size) {
+    const std::size_t guard_size = page_size();
+    if (munmap(static_cast<std::byte*>(stack) - guard_size, size + guard_size) != 0) {
+        log_error("Failed to unmap fiber stack: {}", std::strerror(errno));
+    }
+}
+} // namespace vee
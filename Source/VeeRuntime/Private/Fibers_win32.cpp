@@ -0,0 +1,54 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Assert.hpp"
+#include "Logging.hpp"
+
+#include <Windows.h>
+
+#include <cstddef>
+
+namespace vee {
+static std::size_t page_size() {
+    static const std::size_t size = [] {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwPageSize);
+    }();
+    return size;
+}
+
+void* allocate_fiber_stack(std::size_t size) {
+    VASSERT(size % page_size() == 0, "Fiber stack size {} is not a multiple of the page size {}", size, page_size());
+    // Reserve one extra page below the stack and make it inaccessible so that an overflow faults
+    // instead of silently corrupting whatever is mapped next to it.
+    const std::size_t guard_size = page_size();
+    void* mapping = VirtualAlloc(nullptr, size + guard_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (mapping == nullptr) {
+        log_fatal("Failed to allocate fiber stack of size {}. GetLastError: {}", size, GetLastError());
+    }
+    DWORD old_protection;
+    if (VirtualProtect(mapping, guard_size, PAGE_NOACCESS, &old_protection) == 0) {
+        log_fatal("Failed to protect fiber stack guard page. GetLastError: {}", GetLastError());
+    }
+    return static_cast<std::byte*>(mapping) + guard_size;
+}
+
+void free_fiber_stack(void* stack, std::size_t) {
+    if (VirtualFree(static_cast<std::byte*>(stack) - page_size(), 0, MEM_RELEASE) == 0) {
+        log_error("Failed to free fiber stack. GetLastError: {}", GetLastError());
+    }
+}
+} // namespace vee
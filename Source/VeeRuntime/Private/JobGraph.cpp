@@ -0,0 +1,119 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "JobGraph.hpp"
+
+#include "Assert.hpp"
+
+#include <tracy/Tracy.hpp>
+
+namespace vee {
+JobGraphNode JobGraph::add_node(Name name, JobFunction entry, JobPriority priority) {
+    compiled_ = false;
+    nodes_.push_back({.name = name, .entry = std::move(entry), .priority = priority});
+    return {static_cast<uint32_t>(nodes_.size() - 1)};
+}
+
+void JobGraph::add_dependency(JobGraphNode before, JobGraphNode after) {
+    VASSERT(before.index < nodes_.size() && after.index < nodes_.size(), "JobGraph dependency refers to a node of another graph");
+    VASSERT(before.index != after.index, "JobGraph node can't depend on itself");
+    compiled_ = false;
+    dependencies_.emplace_back(before.index, after.index);
+}
+
+void JobGraph::compile() {
+    ZoneScoped;
+    VASSERT(counter_.is_complete(), "JobGraph was compiled while it was running");
+    const auto num_nodes = static_cast<uint32_t>(nodes_.size());
+
+    for (Node& node : nodes_) {
+        node.num_dependencies = 0;
+        node.num_successors = 0;
+    }
+    for (const auto& [before, after] : dependencies_) {
+        ++nodes_[before].num_successors;
+        ++nodes_[after].num_dependencies;
+    }
+
+    // Lay out every node's successors contiguously
+    uint32_t first_successor = 0;
+    for (Node& node : nodes_) {
+        node.first_successor = first_successor;
+        first_successor += node.num_successors;
+    }
+    successors_.resize(dependencies_.size());
+    std::vector<uint32_t> num_placed(num_nodes, 0);
+    for (const auto& [before, after] : dependencies_) {
+        successors_[nodes_[before].first_successor + num_placed[before]++] = after;
+    }
+
+    // Every node must be reachable by repeatedly removing nodes without remaining dependencies,
+    // otherwise some of them form a cycle and would never run.
+    std::vector<uint32_t> remaining(num_nodes);
+    std::vector<uint32_t> ready;
+    for (uint32_t i = 0; i < num_nodes; ++i) {
+        remaining[i] = nodes_[i].num_dependencies;
+        if (remaining[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    root_jobs_.clear();
+    for (const uint32_t index : ready) {
+        root_jobs_.push_back({nodes_[index].name, [this, index] { run_node(index); }, &counter_, nodes_[index].priority});
+    }
+    uint32_t num_visited = 0;
+    while (!ready.empty()) {
+        const Node& node = nodes_[ready.back()];
+        ready.pop_back();
+        ++num_visited;
+        for (uint32_t i = 0; i < node.num_successors; ++i) {
+            const uint32_t successor = successors_[node.first_successor + i];
+            if (--remaining[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+    VASSERT(num_visited == num_nodes, "JobGraph contains a dependency cycle");
+
+    pending_dependencies_ = std::make_unique<std::atomic<uint32_t>[]>(num_nodes);
+    compiled_ = true;
+}
+
+void JobGraph::run(JobCounter* wait_counter) {
+    ZoneScoped;
+    VASSERT(compiled_, "JobGraph must be compiled before it runs");
+    VASSERT(counter_.is_complete(), "JobGraph was run again before the previous run completed");
+
+    // Publishing the root jobs orders these stores before any node can run
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        pending_dependencies_[i].store(nodes_[i].num_dependencies, std::memory_order_relaxed);
+    }
+    JobManager::queue_jobs(root_jobs_, wait_counter);
+}
+
+void JobGraph::run_node(uint32_t index) {
+    Node& node = nodes_[index];
+    node.entry();
+
+    // Successors are queued before this job signals counter_, so it can't reach zero early
+    for (uint32_t i = 0; i < node.num_successors; ++i) {
+        const uint32_t successor = successors_[node.first_successor + i];
+        if (pending_dependencies_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            const Node& successor_node = nodes_[successor];
+            JobManager::queue_job({successor_node.name, [this, successor] { run_node(successor); }, &counter_, successor_node.priority});
+        }
+    }
+}
+} // namespace vee
@@ -15,209 +15,1660 @@
 #include "JobManager.hpp"
 
 #include "Assert.hpp"
+#include "CpuTopology.hpp"
+#include "FiberSync.hpp"
 #include "Fibers.hpp"
+#include "JobScheduler.hpp"
 #include "Logging.hpp"
+#include "TimerWheel.hpp"
+#include "WorkStealingDeque.hpp"
 
 #include <tracy/Tracy.hpp>
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <deque>
+#include <format>
+#include <immintrin.h>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifndef VEE_JOB_STATS
+#define VEE_JOB_STATS 0
+#endif
+
+#ifndef VEE_FIBER_STACK_PAINTING
+#define VEE_FIBER_STACK_PAINTING 0
+#endif
+
 namespace vee {
+struct ParallelFor {
+    JobManager::detail::RangeFn invoke;
+    void* fn;
+    std::size_t grain;
+    JobPriority priority;
+    JobStackSize stack_size;
+    JobCounter counter;
+};
+
 struct Job {
-    std::atomic<uint32_t>* signal_counter = nullptr;
-    Fiber fiber;
+    Name name;
+    JobFunction entry;
+    JobCounter* signal_counter = nullptr;
+    JobPriority priority = JobPriority::Normal;
+    bool main_thread_only = false;
+    // Runs on the worker's own stack, see JobDecl::leaf
+    bool leaf = false;
+    JobStackSize stack_size = JobStackSize::Large;
+    // Assigned from the fiber pool when the job first starts running
+    Fiber* fiber = nullptr;
+    // Next job in the waiter list of the counter this job is waiting on
+    Job* next_waiter = nullptr;
+    // Value of that counter the job is waiting for
+    uint32_t wait_target = 0;
+    // When the job was last made ready to run. Only set when collecting stats.
+    uint64_t ready_at_ns = 0;
+
+    /**
+     * Add this job to counter's waiter list, to be made ready once the counter drops to target.
+     * @return false if the counter already reached target. The job was not added and can run now.
+     */
+    bool wait_on(JobCounter& counter, uint32_t target = 0);
+
+    /**
+     * Add a batch of jobs to counter's waiter list under a single lock.
+     * @return false if the counter already reached target. No job was added and they can run now.
+     */
+    static bool wait_on(JobCounter& counter, std::span<Job* const> jobs, uint32_t target = 0);
+
+    /**
+     * Account for count newly queued jobs that will signal counter.
+     */
+    static void add_to_counter(JobCounter& counter, uint32_t count);
+
+    /**
+     * Decrement counter and make every waiter whose target it reached ready.
+     */
+    static void signal(JobCounter& counter);
+
+    /**
+     * Signal the job's counter, if any. Called once when the job terminates.
+     */
+    void signal_completion();
 };
 
-struct WaitingJob {
-    Job job;
-    std::atomic<uint32_t>* wait_counter = nullptr;
+/**
+ * A delayed or periodic job waiting in the timer wheel.
+ */
+struct Timer {
+    // In timer ticks since JobManager::init
+    uint64_t deadline = 0;
+    Timer* next = nullptr;
+    JobDecl decl;
+    // Ticks between runs of a periodic job, or 0 for a delayed job
+    uint64_t period = 0;
+    // Cancelled periodic jobs stay in the wheel until they would have run next
+    bool cancelled = false;
 };
 
+// Timers tick once per millisecond
+constexpr static uint64_t TIMER_TICK_NS = 1'000'000;
+constexpr static uint64_t NO_TIMER_DEADLINE = std::numeric_limits<uint64_t>::max();
+constexpr static uint32_t NO_TIMER_SLEEPER = std::numeric_limits<uint32_t>::max();
+
 struct PostSchedulerAction {
-    enum class Type { Yield, Suspend, Terminate };
+    enum class Type { Yield, Suspend, Park, Terminate };
 
     Type type;
-    std::atomic<uint32_t>* wait_counter;
+    JobCounter* wait_counter;
+    JobManager::ParkFn park = nullptr;
+    void* park_context = nullptr;
+    uint32_t wait_target = 0;
+};
+
+/**
+ * Free list shared by all threads. Worker-local caches are refilled from and spilled to it in
+ * batches, so the mutex is only taken once every few allocations.
+ */
+template <typename T>
+struct SharedPool {
+    std::mutex mutex;
+    std::vector<T*> free;
+    std::atomic<std::size_t> num_free = 0;
+
+    /**
+     * Move up to out.size() objects from the pool into out.
+     * @return The number of objects taken.
+     */
+    std::size_t take(std::span<T*> out) {
+        if (num_free.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        std::lock_guard lock(mutex);
+        const std::size_t count = std::min(free.size(), out.size());
+        std::ranges::copy(std::span(free).last(count), out.begin());
+        free.resize(free.size() - count);
+        num_free.fetch_sub(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    void give(std::span<T* const> objects) {
+        std::lock_guard lock(mutex);
+        free.insert(free.end(), objects.begin(), objects.end());
+        num_free.fetch_add(objects.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Top up an empty local cache with up to count objects.
+     */
+    void refill(std::vector<T*>& cache, std::size_t count) {
+        const std::size_t old_size = cache.size();
+        cache.resize(old_size + count);
+        cache.resize(old_size + take(std::span(cache).subspan(old_size)));
+    }
+
+    /**
+     * Move the last count objects of a local cache back to the pool.
+     */
+    void spill(std::vector<T*>& cache, std::size_t count) {
+        give(std::span(cache).last(count));
+        cache.resize(cache.size() - count);
+    }
+};
+
+struct Worker {
+    std::size_t index = 0;
+    std::thread thread;
+    // One deque per JobPriority
+    std::array<WorkStealingDeque<Job*>, NUM_JOB_PRIORITIES> jobs;
+    // Jobs this worker picked up so far, used for starvation protection. Only touched by the worker.
+    uint32_t num_jobs_found = 0;
+
+    // Fibers and job records are recycled through small worker-local caches first, which are
+    // refilled from and spilled to the shared pools in batches.
+    // One fiber cache per JobStackSize
+    std::array<std::vector<Fiber*>, NUM_JOB_STACK_SIZES> free_fibers;
+    std::vector<Job*> free_jobs;
+    std::atomic<uint64_t> fiber_pool_hits = 0;
+    std::atomic<uint64_t> fiber_pool_misses = 0;
+
+    // Futex word an idle worker sleeps on. Set to 1 by whoever wakes it.
+    std::atomic<uint32_t> park_word = 0;
+
+    // Peak stack usage of the jobs that finished on this worker, only kept while painting fiber
+    // stacks. Merged across workers by stack_usage().
+    std::mutex stack_usage_mutex;
+    std::unordered_map<Name, JobStackUsage> stack_usage;
+
+    // Scheduler statistics, only written by the worker itself. Kept on their own cache line so
+    // that reading them doesn't disturb the fields above.
+    struct Stats {
+        std::atomic<uint64_t> jobs_run = 0;
+        std::atomic<uint64_t> steals = 0;
+        std::atomic<uint64_t> suspends = 0;
+        std::atomic<uint64_t> idle_ns = 0;
+        // Start of the current idle stretch, or 0 while running jobs
+        std::atomic<uint64_t> idle_since_ns = 0;
+        std::array<std::atomic<uint64_t>, NUM_QUEUE_LATENCY_BUCKETS> queue_latency = {};
+    };
+    alignas(64) Stats stats;
+};
+
+/**
+ * Jobs queued from threads that aren't workers, or that overflowed a worker's deque.
+ */
+struct InjectionQueue {
+    std::mutex mutex;
+    std::deque<Job*> jobs;
+    std::atomic<std::size_t> size = 0;
 };
 
 struct JobManagerState {
     std::atomic<bool> running = true;
-    std::vector<std::thread> workers;
+    // The main thread is the first worker, followed by the worker threads
+    std::vector<std::unique_ptr<Worker>> workers;
+    Worker* main_worker = nullptr;
+
+    // One queue per JobPriority
+    std::array<InjectionQueue, NUM_JOB_PRIORITIES> injected_jobs;
+    // Jobs that may only run on the main thread, regardless of priority
+    InjectionQueue main_thread_jobs;
+
+    // Critical jobs that were queued but haven't terminated yet. Background jobs are throttled
+    // while this is non-zero.
+    std::atomic<uint32_t> num_critical_pending = 0;
+    // Workers currently running a background job
+    std::atomic<uint32_t> num_background_running = 0;
+
+    // One pool per JobStackSize
+    std::array<SharedPool<Fiber>, NUM_JOB_STACK_SIZES> fiber_pools;
+    std::atomic<std::size_t> num_fibers = 0;
+    std::atomic<std::size_t> num_stack_bytes = 0;
+    SharedPool<Job> job_pool;
+
+    // One bit per worker that's parked and waiting to be woken.
+    std::atomic<uint64_t> parked_workers = 0;
+    // Workers that are spinning while looking for a job. Producers don't wake a parked worker while
+    // one of these is around to pick up the job.
+    std::atomic<uint32_t> num_searching = 0;
 
-    std::mutex queue_mutex;
-    std::deque<Job> fibers;
+    // Delayed and periodic jobs. Workers check for timers that are due between jobs.
+    std::mutex timer_mutex;
+    TimerWheel<Timer> timers;
+    std::unordered_map<uint64_t, Timer*> periodic_timers;
+    uint64_t next_periodic_id = 1;
+    // When the next timer may fire, so that workers only take the lock when something is due
+    std::atomic<uint64_t> next_timer_deadline_ns = NO_TIMER_DEADLINE;
+    // The one parked worker that sleeps with a timeout until the next timer instead of for good
+    std::atomic<uint32_t> timer_sleeper = NO_TIMER_SLEEPER;
 
-    std::mutex wait_mutex;
-    std::vector<WaitingJob> waiting_jobs;
+    uint64_t start_time_ns = 0;
+    // Tracy keeps the plot name pointers around, so the per-worker names live as long as we do
+    std::vector<std::string> utilization_plot_names;
+    // Only touched by plot_stats
+    JobManagerStats last_plotted_stats;
 };
 
+constexpr static std::size_t LOCAL_FIBER_CACHE_SIZE = 32;
+constexpr static std::size_t LOCAL_JOB_CACHE_SIZE = 64;
+// Bounded by the width of JobManagerState::parked_workers
+constexpr static std::size_t MAX_WORKERS = 64;
+// An idle worker polls for work this many times, pausing between attempts, then yields its time
+// slice this many times before parking.
+constexpr static uint32_t IDLE_SPIN_ATTEMPTS = 64;
+constexpr static uint32_t IDLE_YIELD_ATTEMPTS = 16;
+// Every this many jobs, a worker looks for work lowest priority first so that a steady stream of
+// high priority jobs can't starve the rest.
+constexpr static uint32_t STARVATION_INTERVAL = 16;
+// Number of workers that may keep running background jobs while critical jobs are pending
+constexpr static uint32_t MAX_THROTTLED_BACKGROUND_WORKERS = 1;
+// parallel_for initially splits its range into this many pieces per worker
+constexpr static std::size_t PARALLEL_FOR_PIECES_PER_WORKER = 4;
+// Batches are processed in blocks of this many jobs to avoid allocating scratch space
+constexpr static std::size_t JOB_BATCH_BLOCK_SIZE = 256;
+// Times wait_for_counter polls the counter before suspending or blocking
+constexpr static uint32_t WAIT_SPIN_ATTEMPTS = 100;
+// Scheduler statistics cost a clock read per job, so they are compiled out unless requested
+constexpr static bool COLLECT_STATS = VEE_JOB_STATS;
+// Measuring stack usage scans and repaints the used part of a job's stack when it finishes, and
+// commits the whole stack up front
+constexpr static bool PAINT_FIBER_STACKS = VEE_FIBER_STACK_PAINTING;
+// Bytes per JobStackSize
+constexpr static std::array<std::size_t, NUM_JOB_STACK_SIZES> JOB_STACK_SIZES = {32 * 1024, 128 * 1024, 512 * 1024};
+// Jobs using more than this fraction of their stack are reported at shutdown
+constexpr static std::size_t STACK_USAGE_WARNING_PERCENT = 75;
+
+static const Name PARALLEL_FOR_JOB_NAME = "parallel_for"_hash;
+
 static JobManagerState* state = nullptr;
+thread_local static Worker* current_worker_ = nullptr;
 thread_local static Fiber worker_fiber_;
-thread_local static std::optional<Job> current_job_;
+thread_local static Job* current_job_ = nullptr;
+thread_local static Job* yielded_job_ = nullptr;
 thread_local static std::optional<PostSchedulerAction> post_scheduler_action;
+thread_local static uint32_t steal_rng_state_ = 0;
 
 extern void lock_thread_to_core(std::thread& thread, std::size_t core_num);
+extern void futex_wait(std::atomic<uint32_t>& word, uint32_t expected);
+extern void futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, uint64_t timeout_ns);
+extern void futex_wake_one(std::atomic<uint32_t>& word);
 
-void job_main(void (*job)()) {
-    job();
-    JobManager::terminate();
+/**
+ * Jobs can be resumed on a different thread than the one they were suspended on, so thread_locals
+ * must not be cached across a context switch. Reading through a function the compiler can't see
+ * into guarantees a fresh lookup.
+ */
+[[gnu::noinline]] static Job* get_current_job() {
+    return current_job_;
 }
 
-void worker_main() {
-    ZoneScoped;
-    VASSERT(state != nullptr, "Worker thread started without JobManager being initialized");
+/**
+ * @see get_current_job()
+ */
+[[gnu::noinline]] static Worker* get_current_worker() {
+    return current_worker_;
+}
 
-    tracy::SetThreadName("Worker");
-    convert_thread_to_fiber(worker_fiber_);
+static uint64_t clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
 
-    while (state->running) {
-        if (!current_job_) {
-            std::lock_guard lock(state->queue_mutex);
-            if (!state->fibers.empty()) {
-                current_job_ = state->fibers.front();
-                state->fibers.pop_front();
+/**
+ * Add to a statistics counter that only one thread writes to. A plain load and store avoids the
+ * locked instruction fetch_add would need.
+ */
+static void add_stat(std::atomic<uint64_t>& stat, uint64_t amount = 1) {
+    stat.store(stat.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static std::size_t queue_latency_bucket(uint64_t latency_ns) {
+    return std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(latency_ns / 1000)), NUM_QUEUE_LATENCY_BUCKETS - 1);
+}
+
+/**
+ * Entry point for every pooled fiber. When a job terminates its fiber goes back to the pool, and
+ * resumes at the top of this loop the next time it's handed a job.
+ */
+[[noreturn]] static void job_fiber_main() {
+    while (true) {
+        get_current_job()->entry();
+        JobManager::terminate();
+    }
+}
+
+static std::size_t stack_size_index(JobStackSize stack_size) {
+    return static_cast<std::size_t>(stack_size);
+}
+
+static Fiber* create_pooled_fiber(JobStackSize stack_size) {
+    const std::size_t stack_bytes = JOB_STACK_SIZES[stack_size_index(stack_size)];
+    state->num_fibers.fetch_add(1, std::memory_order_relaxed);
+    state->num_stack_bytes.fetch_add(stack_bytes, std::memory_order_relaxed);
+    auto* fiber = new Fiber(create_fiber(job_fiber_main, "Job"_hash, stack_bytes));
+    if constexpr (PAINT_FIBER_STACKS) {
+        paint_fiber_stack(*fiber);
+    }
+    return fiber;
+}
+
+static Fiber* acquire_fiber(Worker& worker, JobStackSize stack_size) {
+    std::vector<Fiber*>& cache = worker.free_fibers[stack_size_index(stack_size)];
+    if (cache.empty()) {
+        state->fiber_pools[stack_size_index(stack_size)].refill(cache, LOCAL_FIBER_CACHE_SIZE / 2);
+    }
+
+    if (cache.empty()) {
+        worker.fiber_pool_misses.fetch_add(1, std::memory_order_relaxed);
+        return create_pooled_fiber(stack_size);
+    }
+
+    worker.fiber_pool_hits.fetch_add(1, std::memory_order_relaxed);
+    Fiber* fiber = cache.back();
+    cache.pop_back();
+    return fiber;
+}
+
+static void release_fiber(Worker& worker, Fiber* fiber, JobStackSize stack_size) {
+    std::vector<Fiber*>& cache = worker.free_fibers[stack_size_index(stack_size)];
+    cache.push_back(fiber);
+    if (cache.size() <= LOCAL_FIBER_CACHE_SIZE) {
+        return;
+    }
+
+    // Spill half of the local cache so that workers that mostly finish jobs started elsewhere don't
+    // hoard fibers.
+    state->fiber_pools[stack_size_index(stack_size)].spill(cache, LOCAL_FIBER_CACHE_SIZE / 2);
+}
+
+static void destroy_pooled_fiber(Fiber* fiber) {
+    state->num_stack_bytes.fetch_sub(fiber->stack_size, std::memory_order_relaxed);
+    destroy_fiber(*fiber);
+    delete fiber;
+    state->num_fibers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * Record how much of its stack a finished job used, then repaint what it dirtied for the next job.
+ */
+static void record_stack_usage(Worker& worker, const Job& job) {
+    const std::size_t used = fiber_stack_high_water_mark(*job.fiber);
+    paint_fiber_stack(*job.fiber, used);
+
+    std::lock_guard lock(worker.stack_usage_mutex);
+    JobStackUsage& usage = worker.stack_usage[job.name];
+    usage.name = job.name;
+    usage.peak_bytes = std::max(usage.peak_bytes, used);
+    usage.stack_size = job.stack_size;
+}
+
+/**
+ * Fill jobs with blank job records. Workers take them from their local cache, other threads take
+ * them straight from the shared pool. Records are only allocated when the pools run dry.
+ */
+static void acquire_jobs(std::span<Job*> jobs) {
+    std::size_t num_acquired = 0;
+    if (Worker* worker = get_current_worker(); worker != nullptr) {
+        std::vector<Job*>& cache = worker->free_jobs;
+        if (cache.size() < jobs.size()) {
+            state->job_pool.refill(cache, std::max(LOCAL_JOB_CACHE_SIZE / 2, jobs.size() - cache.size()));
+        }
+        num_acquired = std::min(cache.size(), jobs.size());
+        std::ranges::copy(std::span(cache).last(num_acquired), jobs.begin());
+        cache.resize(cache.size() - num_acquired);
+    } else {
+        num_acquired = state->job_pool.take(jobs);
+    }
+
+    for (Job*& job : jobs.subspan(num_acquired)) {
+        job = new Job();
+    }
+}
+
+static Job* acquire_job() {
+    Job* job = nullptr;
+    acquire_jobs({&job, 1});
+    return job;
+}
+
+static void release_job(Worker& worker, Job* job) {
+    // Release whatever the closure captured now rather than when the record is reused
+    job->entry.reset();
+    job->signal_counter = nullptr;
+    job->fiber = nullptr;
+    job->next_waiter = nullptr;
+
+    worker.free_jobs.push_back(job);
+    if (worker.free_jobs.size() > LOCAL_JOB_CACHE_SIZE) {
+        state->job_pool.spill(worker.free_jobs, LOCAL_JOB_CACHE_SIZE / 2);
+    }
+}
+
+static std::size_t priority_index(JobPriority priority) {
+    return static_cast<std::size_t>(priority);
+}
+
+/**
+ * Account for count newly queued jobs of the given priority.
+ */
+static void add_pending_jobs(JobPriority priority, uint32_t count) {
+    if (priority == JobPriority::Critical) {
+        state->num_critical_pending.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+static void inject_jobs(InjectionQueue& queue, std::span<Job* const> jobs) {
+    std::lock_guard lock(queue.mutex);
+    queue.jobs.insert(queue.jobs.end(), jobs.begin(), jobs.end());
+    queue.size.fetch_add(jobs.size(), std::memory_order_release);
+}
+
+static void unpark_worker(Worker& worker) {
+    worker.park_word.store(1, std::memory_order_release);
+    futex_wake_one(worker.park_word);
+}
+
+/**
+ * Wake up to count parked workers. Workers that are already searching for work count towards the
+ * total.
+ */
+static void wake_idle_workers(std::size_t count) {
+    // Pairs with the fence in park_worker. Either the parking worker sees the job that was just
+    // pushed, or we see its bit in parked_workers.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::size_t num_searching = state->num_searching.load(std::memory_order_relaxed);
+    if (num_searching >= count) {
+        return;
+    }
+    count -= num_searching;
+
+    uint64_t parked = state->parked_workers.load(std::memory_order_relaxed);
+    while (parked != 0 && count > 0) {
+        const uint64_t lowest = parked & (~parked + 1);
+        if (state->parked_workers.compare_exchange_weak(parked, parked & ~lowest, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            unpark_worker(*state->workers[static_cast<std::size_t>(std::countr_zero(lowest))]);
+            parked &= ~lowest;
+            --count;
+        }
+    }
+}
+
+/**
+ * Make jobs runnable. Worker threads push to their own deque, everyone else goes through the
+ * injection queue. Main-thread-only jobs always go to the main thread's queue.
+ */
+static void push_ready_jobs(std::span<Job* const> jobs) {
+    if constexpr (COLLECT_STATS) {
+        const uint64_t now = clock_ns();
+        for (Job* job : jobs) {
+            job->ready_at_ns = now;
+        }
+    }
+
+    Worker* worker = get_current_worker();
+    std::size_t num_main_thread_jobs = 0;
+    // Each run of jobs with the same priority and affinity is published at once
+    for (std::size_t run_begin = 0; run_begin < jobs.size();) {
+        const JobPriority priority = jobs[run_begin]->priority;
+        const bool main_thread_only = jobs[run_begin]->main_thread_only;
+        std::size_t run_end = run_begin + 1;
+        while (run_end < jobs.size() && jobs[run_end]->priority == priority && jobs[run_end]->main_thread_only == main_thread_only) {
+            ++run_end;
+        }
+        const std::span<Job* const> run = jobs.subspan(run_begin, run_end - run_begin);
+        run_begin = run_end;
+
+        if (main_thread_only) {
+            inject_jobs(state->main_thread_jobs, run);
+            num_main_thread_jobs += run.size();
+            continue;
+        }
+
+        std::size_t num_pushed = 0;
+        if (worker != nullptr) {
+            num_pushed = worker->jobs[priority_index(priority)].push_batch(run);
+        }
+        if (num_pushed < run.size()) {
+            inject_jobs(state->injected_jobs[priority_index(priority)], run.subspan(num_pushed));
+        }
+    }
+    wake_idle_workers(jobs.size() - num_main_thread_jobs);
+}
+
+static void push_ready_job(Job* job) {
+    push_ready_jobs({&job, 1});
+}
+
+static Job* pop_injected_job(InjectionQueue& queue) {
+    if (queue.size.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+
+    std::lock_guard lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return nullptr;
+    }
+    Job* job = queue.jobs.front();
+    queue.jobs.pop_front();
+    queue.size.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+static Job* steal_job(Worker& thief, JobPriority priority) {
+    const std::size_t num_workers = state->workers.size();
+    if (num_workers < 2) {
+        return nullptr;
+    }
+
+    // xorshift32, start at a random victim so that thieves don't all hammer the same deque.
+    steal_rng_state_ ^= steal_rng_state_ << 13;
+    steal_rng_state_ ^= steal_rng_state_ >> 17;
+    steal_rng_state_ ^= steal_rng_state_ << 5;
+    const std::size_t first_victim = steal_rng_state_ % num_workers;
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        const std::size_t victim = (first_victim + i) % num_workers;
+        if (victim == thief.index) {
+            continue;
+        }
+        if (Job* job = state->workers[victim]->jobs[priority_index(priority)].steal()) {
+            if constexpr (COLLECT_STATS) {
+                add_stat(thief.stats.steals);
             }
+            return job;
         }
+    }
+    return nullptr;
+}
 
-        if (!current_job_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+static Job* find_job(Worker& worker, JobPriority priority) {
+    if (Job* job = worker.jobs[priority_index(priority)].pop()) {
+        return job;
+    }
+    if (Job* job = pop_injected_job(state->injected_jobs[priority_index(priority)])) {
+        return job;
+    }
+    return steal_job(worker, priority);
+}
+
+/**
+ * Background jobs only start while no critical jobs are pending, or while fewer than
+ * MAX_THROTTLED_BACKGROUND_WORKERS workers are busy with them.
+ */
+static bool background_jobs_allowed() {
+    return state->num_critical_pending.load(std::memory_order_relaxed) == 0
+        || state->num_background_running.load(std::memory_order_relaxed) < MAX_THROTTLED_BACKGROUND_WORKERS;
+}
+
+/**
+ * Look for a job, highest priority first. Every STARVATION_INTERVAL jobs the search goes lowest
+ * priority first instead.
+ */
+static Job* find_job(Worker& worker) {
+    const bool lowest_first = worker.num_jobs_found % STARVATION_INTERVAL == STARVATION_INTERVAL - 1;
+    for (std::size_t i = 0; i < NUM_JOB_PRIORITIES; ++i) {
+        const auto priority = static_cast<JobPriority>(lowest_first ? NUM_JOB_PRIORITIES - 1 - i : i);
+        if (priority == JobPriority::Background && !background_jobs_allowed()) {
             continue;
         }
+        if (Job* job = find_job(worker, priority)) {
+            ++worker.num_jobs_found;
+            return job;
+        }
+    }
+    return nullptr;
+}
 
-        log_trace("JobManager: Starting/Resuming {}", current_job_->fiber.name);
-        switch_to_fiber(current_job_->fiber);
-        if (post_scheduler_action) {
-            switch (post_scheduler_action->type) {
-            case PostSchedulerAction::Type::Yield: {
-                std::lock_guard lock(state->queue_mutex);
-                state->fibers.push_back(*current_job_);
-                break;
+static void init_job(Job& job, JobDecl&& decl) {
+    job.name = decl.name;
+    job.entry = std::move(decl.entry);
+    job.signal_counter = decl.signal_counter;
+    job.priority = decl.priority;
+    job.main_thread_only = decl.main_thread_only;
+    job.leaf = decl.leaf;
+    job.stack_size = decl.stack_size;
+}
+
+static uint64_t timer_ticks(uint64_t time_ns) {
+    return (time_ns - state->start_time_ns) / TIMER_TICK_NS;
+}
+
+/**
+ * Publish when the wheel next needs attention. Must hold timer_mutex.
+ */
+static void update_next_timer_deadline() {
+    const uint64_t next_event = state->timers.next_event();
+    const uint64_t deadline = next_event == TimerWheel<Timer>::NO_DEADLINE ? NO_TIMER_DEADLINE : state->start_time_ns + next_event * TIMER_TICK_NS;
+    state->next_timer_deadline_ns.store(deadline, std::memory_order_seq_cst);
+}
+
+/**
+ * Queue the jobs of every timer that is due. Must hold timer_mutex.
+ */
+static void expire_timers(uint64_t now_ns) {
+    const uint64_t now = timer_ticks(now_ns);
+    state->timers.advance(now, [now](Timer* timer) {
+        if (timer->cancelled) {
+            delete timer;
+        } else if (timer->period == 0) {
+            // The counter was already incremented when the job was queued
+            Job* job = acquire_job();
+            init_job(*job, std::move(timer->decl));
+            add_pending_jobs(job->priority, 1);
+            push_ready_job(job);
+            delete timer;
+        } else {
+            JobManager::queue_job(timer->decl);
+            // Skip the runs we fell behind on
+            timer->deadline += ((now - timer->deadline) / timer->period + 1) * timer->period;
+            state->timers.insert(timer);
+        }
+    });
+    update_next_timer_deadline();
+}
+
+/**
+ * Queue the jobs of timers that are due. Without any due timers this is an atomic load and at most
+ * a clock read, so workers call it between every job.
+ */
+static void poll_timers() {
+    const uint64_t deadline = state->next_timer_deadline_ns.load(std::memory_order_relaxed);
+    if (deadline == NO_TIMER_DEADLINE) {
+        return;
+    }
+    const uint64_t now = clock_ns();
+    if (now < deadline) {
+        return;
+    }
+    // If another worker holds the lock, it is already expiring them
+    std::unique_lock lock(state->timer_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        expire_timers(now);
+    }
+}
+
+/**
+ * Get a worker to notice a timer that became the earliest one. The timer sleeper is woken up to
+ * pick a shorter timeout, or without one, a parked worker is woken up to become it.
+ */
+static void wake_timer_sleeper() {
+    // Pairs with the fence in park_worker, like in wake_idle_workers
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const uint32_t sleeper = state->timer_sleeper.load(std::memory_order_relaxed);
+    if (sleeper == NO_TIMER_SLEEPER) {
+        wake_idle_workers(1);
+        return;
+    }
+    const uint64_t bit = uint64_t{1} << sleeper;
+    if ((state->parked_workers.fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0) {
+        unpark_worker(*state->workers[sleeper]);
+    }
+}
+
+static void add_timer(Timer* timer, std::chrono::nanoseconds delay) {
+    const uint64_t now_ns = clock_ns();
+    const auto delay_ns = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(delay.count(), 0));
+
+    std::lock_guard lock(state->timer_mutex);
+    // The wheel only moves while it has timers, so catch it up before measuring the delay from it
+    expire_timers(now_ns);
+    const uint64_t previous_deadline = state->next_timer_deadline_ns.load(std::memory_order_relaxed);
+    // Round up so that the timer never fires early
+    timer->deadline = (now_ns - state->start_time_ns + delay_ns + TIMER_TICK_NS - 1) / TIMER_TICK_NS;
+    state->timers.insert(timer);
+    update_next_timer_deadline();
+    if (state->next_timer_deadline_ns.load(std::memory_order_relaxed) < previous_deadline) {
+        wake_timer_sleeper();
+    }
+}
+
+void JobCounter::lock() {
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+        while (locked_.load(std::memory_order_relaxed)) {
+            _mm_pause();
+        }
+    }
+}
+
+void JobCounter::unlock() {
+    locked_.store(false, std::memory_order_release);
+}
+
+void detail::JobWaitList::lock() {
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+        while (locked_.load(std::memory_order_relaxed)) {
+            _mm_pause();
+        }
+    }
+}
+
+void detail::JobWaitList::unlock() {
+    locked_.store(false, std::memory_order_release);
+}
+
+void detail::JobWaitList::push(Job* job) {
+    job->next_waiter = nullptr;
+    if (tail_ == nullptr) {
+        head_ = job;
+    } else {
+        tail_->next_waiter = job;
+    }
+    tail_ = job;
+}
+
+Job* detail::JobWaitList::pop() {
+    Job* job = head_;
+    if (job != nullptr) {
+        head_ = job->next_waiter;
+        if (head_ == nullptr) {
+            tail_ = nullptr;
+        }
+        job->next_waiter = nullptr;
+    }
+    return job;
+}
+
+static uint32_t counter_value(uint64_t counter_state) {
+    return static_cast<uint32_t>(counter_state);
+}
+
+static uint32_t counter_max_wait_target(uint64_t counter_state) {
+    return static_cast<uint32_t>(counter_state >> 32);
+}
+
+static uint64_t with_max_wait_target(uint64_t counter_state, uint32_t max_wait_target) {
+    return (uint64_t{max_wait_target} << 32) | counter_value(counter_state);
+}
+
+bool Job::wait_on(JobCounter& counter, uint32_t target) {
+    Job* job = this;
+    return wait_on(counter, {&job, 1}, target);
+}
+
+bool Job::wait_on(JobCounter& counter, std::span<Job* const> jobs, uint32_t target) {
+    // The counter is re-checked under its lock. Any decrement that could reach target also happens
+    // under the lock, so it can't slip in between the check and the jobs being linked into the
+    // waiter list. Raising the max wait target in the same compare-and-swap as the check makes sure
+    // signals that skip the lock can't reach target either.
+    counter.lock();
+    uint64_t counter_state = counter.state_.load(std::memory_order_acquire);
+    do {
+        if (counter_value(counter_state) <= target) {
+            counter.unlock();
+            return false;
+        }
+    } while (target > counter_max_wait_target(counter_state) &&
+             !counter.state_.compare_exchange_weak(counter_state, with_max_wait_target(counter_state, target), std::memory_order_acq_rel, std::memory_order_acquire));
+
+    for (Job* job : jobs) {
+        job->wait_target = target;
+        job->next_waiter = counter.waiters_;
+        counter.waiters_ = job;
+    }
+    counter.unlock();
+    return true;
+}
+
+void Job::add_to_counter(JobCounter& counter, uint32_t count) {
+    counter.state_.fetch_add(count, std::memory_order_relaxed);
+}
+
+static void run_parallel_for_range(ParallelFor& parallel_for, std::size_t begin, std::size_t end);
+
+static void init_parallel_for_job(Job& job, ParallelFor& parallel_for, std::size_t begin, std::size_t end) {
+    job.name = PARALLEL_FOR_JOB_NAME;
+    job.entry = [&parallel_for, begin, end] {
+        run_parallel_for_range(parallel_for, begin, end);
+    };
+    job.signal_counter = &parallel_for.counter;
+    job.priority = parallel_for.priority;
+    job.main_thread_only = false;
+    job.leaf = false;
+    job.stack_size = parallel_for.stack_size;
+}
+
+/**
+ * Process [begin, end) in grain sized chunks. Before each chunk, if this worker's deque has run dry
+ * (other workers stole everything) the upper half of the remaining range is split off into a new
+ * job so that it can be stolen too.
+ */
+static void run_parallel_for_range(ParallelFor& parallel_for, std::size_t begin, std::size_t end) {
+    while (begin < end) {
+        const Worker* worker = get_current_worker();
+        if (end - begin > parallel_for.grain && state->workers.size() > 1 && worker != nullptr
+            && worker->jobs[priority_index(parallel_for.priority)].size_approx() == 0) {
+            const std::size_t middle = begin + (end - begin) / 2;
+            Job* job = acquire_job();
+            init_parallel_for_job(*job, parallel_for, middle, end);
+            Job::add_to_counter(parallel_for.counter, 1);
+            add_pending_jobs(parallel_for.priority, 1);
+            push_ready_job(job);
+            end = middle;
+            continue;
+        }
+
+        const std::size_t chunk_end = begin + std::min(parallel_for.grain, end - begin);
+        parallel_for.invoke(parallel_for.fn, begin, chunk_end);
+        begin = chunk_end;
+    }
+}
+
+void Job::signal_completion() {
+    if (signal_counter != nullptr) {
+        signal(*signal_counter);
+    }
+}
+
+void Job::signal(JobCounter& counter) {
+    // Decrements that can't complete the counter or reach any waiter's target don't need the lock
+    uint64_t counter_state = counter.state_.load(std::memory_order_relaxed);
+    while (counter_value(counter_state) > 1 && counter_value(counter_state) - 1 > counter_max_wait_target(counter_state)) {
+        if (counter.state_.compare_exchange_weak(counter_state, counter_state - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    counter.lock();
+    counter_state = counter.state_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    const uint32_t value = counter_value(counter_state);
+    Job* waiters = nullptr;
+    if (value == 0) {
+        waiters = std::exchange(counter.waiters_, nullptr);
+        counter.state_.fetch_and(~uint64_t{0} >> 32, std::memory_order_relaxed);
+    } else if (value <= counter_max_wait_target(counter_state)) {
+        // Release the waiters whose target was reached, and lower the max wait target to what the
+        // rest are waiting for
+        uint32_t max_wait_target = 0;
+        for (Job** link = &counter.waiters_; *link != nullptr;) {
+            Job* waiter = *link;
+            if (waiter->wait_target >= value) {
+                *link = waiter->next_waiter;
+                waiter->next_waiter = waiters;
+                waiters = waiter;
+            } else {
+                max_wait_target = std::max(max_wait_target, waiter->wait_target);
+                link = &waiter->next_waiter;
             }
-            case PostSchedulerAction::Type::Suspend: {
-                std::lock_guard lock(state->wait_mutex);
-                state->waiting_jobs.emplace_back(*current_job_, post_scheduler_action->wait_counter);
+        }
+        while (!counter.state_.compare_exchange_weak(counter_state, with_max_wait_target(counter_state, max_wait_target), std::memory_order_relaxed)) {
+        }
+    }
+    // The counter may be destroyed as soon as it's unlocked, don't touch it afterward.
+    counter.unlock();
+
+    while (waiters != nullptr) {
+        Job* waiter = std::exchange(waiters, waiters->next_waiter);
+        waiter->next_waiter = nullptr;
+        log_trace("JobManager: Kicking {} due to counter completion", waiter->name);
+        push_ready_job(waiter);
+    }
+}
+
+/**
+ * Sleep until another thread wakes this worker. Advertises the worker as parked first and checks
+ * for work once more so that a job pushed in the meantime isn't missed.
+ * @return A job that was found before going to sleep, if any.
+ */
+static Job* park_worker(Worker& worker) {
+    const uint64_t bit = uint64_t{1} << worker.index;
+    worker.park_word.store(0, std::memory_order_relaxed);
+    state->parked_workers.fetch_or(bit, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (Job* job = find_job(worker); job != nullptr || !state->running) {
+        if ((state->parked_workers.fetch_and(~bit, std::memory_order_acq_rel) & bit) == 0) {
+            // Somebody already claimed us to run their job. We might have taken a different one,
+            // so pass their wakeup on.
+            wake_idle_workers(1);
+        }
+        return job;
+    }
+
+    ZoneScopedN("Parked");
+    uint32_t no_sleeper = NO_TIMER_SLEEPER;
+    if (state->next_timer_deadline_ns.load(std::memory_order_seq_cst) != NO_TIMER_DEADLINE &&
+        state->timer_sleeper.compare_exchange_strong(no_sleeper, static_cast<uint32_t>(worker.index), std::memory_order_seq_cst)) {
+        // Sleep until the next timer is due, rechecking whenever it changes
+        while (worker.park_word.load(std::memory_order_acquire) == 0) {
+            const uint64_t deadline = state->next_timer_deadline_ns.load(std::memory_order_acquire);
+            const uint64_t now = clock_ns();
+            if (deadline == NO_TIMER_DEADLINE) {
+                futex_wait(worker.park_word, 0);
+            } else if (now < deadline) {
+                futex_wait_for(worker.park_word, 0, deadline - now);
+            } else {
                 break;
             }
-            case PostSchedulerAction::Type::Terminate: {
-                // Kick jobs that are waiting on this one if we set the counter to 0
-                if (current_job_->signal_counter && current_job_->signal_counter->fetch_sub(1) == 1) {
-                    std::lock_guard wait_lock(state->wait_mutex);
-                    for (auto wait_it = state->waiting_jobs.begin(); wait_it != state->waiting_jobs.end(); ++wait_it) {
-                        if (wait_it->wait_counter == current_job_->signal_counter) {
-                            log_trace(
-                                "JobManager: Kicking {} due to completion of {}",
-                                wait_it->job.fiber.name,
-                                current_job_->fiber.name
-                            );
-
-                            std::lock_guard lock(state->queue_mutex);
-                            state->fibers.emplace_back(wait_it->job);
-                            wait_it = state->waiting_jobs.erase(wait_it);
-                            if (wait_it == state->waiting_jobs.end()) {
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
+        }
+        state->timer_sleeper.store(NO_TIMER_SLEEPER, std::memory_order_release);
+        if (worker.park_word.load(std::memory_order_acquire) == 0) {
+            // Nobody woke us, stop advertising ourselves as parked before going to fire the timers.
+            // If somebody claimed us in the meantime, we'll pick up their job as well.
+            state->parked_workers.fetch_and(~bit, std::memory_order_acq_rel);
+        }
+        return nullptr;
+    }
+
+    while (worker.park_word.load(std::memory_order_acquire) == 0) {
+        futex_wait(worker.park_word, 0);
+    }
+    return nullptr;
+}
+
+/**
+ * Look for work with an adaptive back-off: spin, then yield, then park.
+ */
+static Job* wait_for_job(Worker& worker) {
+    state->num_searching.fetch_add(1, std::memory_order_seq_cst);
+    Job* job = nullptr;
+    for (uint32_t attempt = 0; job == nullptr && attempt < IDLE_SPIN_ATTEMPTS + IDLE_YIELD_ATTEMPTS; ++attempt) {
+        if (attempt < IDLE_SPIN_ATTEMPTS) {
+            for (int i = 0; i < 16; ++i) {
+                _mm_pause();
+            }
+        } else {
+            std::this_thread::yield();
+        }
+        job = find_job(worker);
+    }
+
+    // Producers skip waking anyone while a worker is searching. If we were the last searcher and
+    // found something, hand the search over to a parked worker in case more jobs are queued.
+    if (state->num_searching.fetch_sub(1, std::memory_order_seq_cst) == 1 && job != nullptr) {
+        wake_idle_workers(1);
+    }
+
+    if (job != nullptr || !state->running) {
+        return job;
+    }
+    return park_worker(worker);
+}
+
+static void begin_idle(Worker& worker) {
+    if constexpr (COLLECT_STATS) {
+        worker.stats.idle_since_ns.store(clock_ns(), std::memory_order_relaxed);
+    }
+}
+
+static void end_idle(Worker& worker) {
+    if constexpr (COLLECT_STATS) {
+        const uint64_t idle_since = worker.stats.idle_since_ns.exchange(0, std::memory_order_relaxed);
+        add_stat(worker.stats.idle_ns, clock_ns() - idle_since);
+    }
+}
+
+static void record_job_start(Worker& worker, const Job& job) {
+    if constexpr (COLLECT_STATS) {
+        add_stat(worker.stats.jobs_run);
+        add_stat(worker.stats.queue_latency[queue_latency_bucket(clock_ns() - job.ready_at_ns)]);
+    }
+}
+
+/**
+ * Signal a terminated job's counter, then recycle its fiber and record.
+ */
+static void finish_job(Worker& worker, Job* job) {
+    job->signal_completion();
+    if (job->priority == JobPriority::Critical && state->num_critical_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Workers may have parked while background jobs were throttled
+        wake_idle_workers(state->workers.size());
+    }
+    if (job->fiber != nullptr) {
+        if constexpr (PAINT_FIBER_STACKS) {
+            record_stack_usage(worker, *job);
+        }
+        release_fiber(worker, job->fiber, job->stack_size);
+    }
+    release_job(worker, job);
+}
+
+/**
+ * Run job on the calling worker until it terminates, yields or suspends, then carry out what it
+ * asked for. A yielded job is left in yielded_job_ for the caller to reschedule.
+ */
+static void run_job(Worker& worker, Job* job) {
+    current_job_ = job;
+    log_trace("JobManager: Starting/Resuming {}", current_job_->name);
+    record_job_start(worker, *current_job_);
+    const bool is_background = current_job_->priority == JobPriority::Background;
+    if (is_background) {
+        state->num_background_running.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (current_job_->leaf) {
+        // Leaf jobs can't suspend, so they run to completion right here without a fiber
+        current_job_->entry();
+    } else {
+        if (current_job_->fiber == nullptr) {
+            current_job_->fiber = acquire_fiber(worker, current_job_->stack_size);
+            current_job_->fiber->name = current_job_->name;
+        }
+        switch_to_fiber(*current_job_->fiber);
+    }
+
+    if (is_background) {
+        state->num_background_running.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (current_job_->leaf) {
+        finish_job(worker, current_job_);
+    } else if (post_scheduler_action) {
+        switch (post_scheduler_action->type) {
+        case PostSchedulerAction::Type::Yield: {
+            if constexpr (COLLECT_STATS) {
+                current_job_->ready_at_ns = clock_ns();
+            }
+            yielded_job_ = current_job_;
+            break;
+        }
+        case PostSchedulerAction::Type::Suspend: {
+            if (!current_job_->wait_on(*post_scheduler_action->wait_counter, post_scheduler_action->wait_target)) {
+                push_ready_job(current_job_);
+            } else if constexpr (COLLECT_STATS) {
+                add_stat(worker.stats.suspends);
             }
+            break;
+        }
+        case PostSchedulerAction::Type::Park: {
+            if (!post_scheduler_action->park(current_job_, post_scheduler_action->park_context)) {
+                push_ready_job(current_job_);
+            } else if constexpr (COLLECT_STATS) {
+                add_stat(worker.stats.suspends);
+            }
+            break;
+        }
+        case PostSchedulerAction::Type::Terminate: {
+            finish_job(worker, current_job_);
+            break;
+        }
+        }
+        post_scheduler_action = std::nullopt;
+    }
+    current_job_ = nullptr;
+}
+
+void worker_main(Worker* worker) {
+    ZoneScoped;
+    VASSERT(state != nullptr, "Worker thread started without JobManager being initialized");
+
+    tracy::SetThreadName("Worker");
+    convert_thread_to_fiber(worker_fiber_);
+    current_worker_ = worker;
+    steal_rng_state_ = static_cast<uint32_t>(worker->index) * 0x9E3779B9u + 1;
+
+    while (state->running) {
+        poll_timers();
+        Job* job = find_job(*worker);
+
+        // A yielded job only runs again right away if there is nothing else to do. Otherwise, it
+        // goes back on our deque where it can also be stolen by idle workers.
+        if (yielded_job_ != nullptr) {
+            if (job == nullptr) {
+                job = yielded_job_;
+            } else {
+                push_ready_job(yielded_job_);
             }
-            post_scheduler_action = std::nullopt;
+            yielded_job_ = nullptr;
         }
-        current_job_ = std::nullopt;
+
+        if (job == nullptr) {
+            begin_idle(*worker);
+            job = wait_for_job(*worker);
+            end_idle(*worker);
+            if (job == nullptr) {
+                continue;
+            }
+        }
+
+        run_job(*worker, job);
     }
 
+    current_worker_ = nullptr;
     convert_fiber_to_thread();
     destroy_fiber(worker_fiber_);
 }
 
-void JobManager::init() {
+/**
+ * Run jobs on the main thread until counter drops to target. Main-thread-only jobs go first since
+ * nobody else can run them.
+ */
+static void help_until_reached(Worker& worker, const JobCounter& counter, uint32_t target) {
+    uint32_t idle_attempts = 0;
+    while (!counter.has_reached(target)) {
+        poll_timers();
+        Job* job = pop_injected_job(state->main_thread_jobs);
+        if (job == nullptr) {
+            job = find_job(worker);
+        }
+
+        if (job == nullptr) {
+            // The main thread never parks, the counter doesn't know how to wake it.
+            if (idle_attempts == 0) {
+                begin_idle(worker);
+            }
+            if (idle_attempts < IDLE_SPIN_ATTEMPTS) {
+                for (int i = 0; i < 16; ++i) {
+                    _mm_pause();
+                }
+            } else {
+                std::this_thread::yield();
+            }
+            ++idle_attempts;
+            continue;
+        }
+
+        if (idle_attempts > 0) {
+            end_idle(worker);
+            idle_attempts = 0;
+        }
+        run_job(worker, job);
+        if (yielded_job_ != nullptr) {
+            push_ready_job(std::exchange(yielded_job_, nullptr));
+        }
+    }
+    if (idle_attempts > 0) {
+        end_idle(worker);
+    }
+}
+
+void JobManager::init(JobManagerConfig config) {
     VASSERT(state == nullptr, "JobManager was already initialized!");
 
     // TODO: Use custom allocators for engine system initialization
     state = new JobManagerState();
-    // ASSUMPTIONS: We're running on a hyper threaded CPU
-    // TODO: Be more picky with which cores we use. For example: only use P cores on Intel; only use
-    // cores on the same CCD on Ryzen; only use cores on the CCD with the 3D V-cache on Ryzen X3D
-    unsigned int core_count = std::thread::hardware_concurrency() / 2;
-    log_info("JobManager is creating {} worker threads.", core_count);
-
-    state->workers.reserve(core_count);
-    for (unsigned int i = 0; i < core_count; ++i) {
-        std::thread worker(&worker_main);
-        lock_thread_to_core(worker, i * 2);
+    state->start_time_ns = clock_ns();
+
+    const CpuTopology topology = probe_cpu_topology();
+    const WorkerCpus worker_cpus = select_worker_cpus(topology, config.placement);
+    log_info("JobManager found {} logical CPUs on {} physical cores in {} cache domains.", topology.cpus.size(), topology.num_cores(), topology.num_cache_domains());
+
+    // The main thread takes one of the preferred cores, but there is always at least one worker
+    // thread so that jobs make progress while the main thread is busy elsewhere.
+    std::size_t thread_count = config.num_workers;
+    if (thread_count == 0) {
+        thread_count = std::max<std::size_t>(worker_cpus.num_preferred, 2) - 1;
+    }
+    if (thread_count > MAX_WORKERS - 1) {
+        log_warning("JobManager supports at most {} worker threads, {} were requested.", MAX_WORKERS - 1, thread_count);
+        thread_count = MAX_WORKERS - 1;
+    }
+    log_info("JobManager is creating {} worker threads.", thread_count);
+
+    // All workers must exist before any of them start so that thieves can index the worker list
+    // without synchronization.
+    const std::size_t worker_count = thread_count + 1;
+    state->workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->index = i;
         state->workers.push_back(std::move(worker));
     }
+    state->main_worker = state->workers.front().get();
+
+    state->utilization_plot_names.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        [[maybe_unused]] const std::string& plot_name = state->utilization_plot_names.emplace_back(i == 0 ? "Main thread utilization" : std::format("Worker {} utilization", i));
+        TracyPlotConfig(plot_name.c_str(), tracy::PlotFormatType::Percentage, false, true, 0);
+    }
+
+    SharedPool<Fiber>& initial_pool = state->fiber_pools[stack_size_index(JobStackSize::Large)];
+    initial_pool.free.reserve(config.initial_fiber_pool_size);
+    for (std::size_t i = 0; i < config.initial_fiber_pool_size; ++i) {
+        initial_pool.free.push_back(create_pooled_fiber(JobStackSize::Large));
+    }
+    initial_pool.num_free = initial_pool.free.size();
+
+    // The main thread is left unpinned, worker threads start at the second CPU so that the first
+    // one is left for it.
+    for (auto& worker : state->workers | std::views::drop(1)) {
+        worker->thread = std::thread(&worker_main, worker.get());
+        if (config.placement != WorkerPlacement::Unpinned && !worker_cpus.cpus.empty()) {
+            lock_thread_to_core(worker->thread, worker_cpus.cpus[worker->index % worker_cpus.cpus.size()]);
+        }
+    }
+
+    convert_thread_to_fiber(worker_fiber_);
+    current_worker_ = state->main_worker;
+    steal_rng_state_ = 1;
 }
 
 void JobManager::yield() {
-    VASSERT(current_job_.has_value(), "Attempted to yield a job without a current job");
+    VASSERT(current_job_ != nullptr, "Attempted to yield a job without a current job");
+    VASSERT(!current_job_->leaf, "Leaf job {} attempted to yield", current_job_->name);
     post_scheduler_action.emplace(PostSchedulerAction::Type::Yield, nullptr);
-    log_trace("JobManager: Yielding from {}", current_job_->fiber.name);
+    log_trace("JobManager: Yielding from {}", current_job_->name);
     switch_to_fiber(worker_fiber_);
 }
 
 void JobManager::terminate() {
-    VASSERT(current_job_.has_value(), "Attempted to terminate a job without a current job");
-    log_trace("JobManager: Terminating {}", current_job_->fiber.name);
+    VASSERT(current_job_ != nullptr, "Attempted to terminate a job without a current job");
+    VASSERT(!current_job_->leaf, "Leaf job {} attempted to terminate", current_job_->name);
+    log_trace("JobManager: Terminating {}", current_job_->name);
     post_scheduler_action.emplace(PostSchedulerAction::Type::Terminate, nullptr);
     switch_to_fiber(worker_fiber_);
 }
 
-void JobManager::wait_for_counter(std::atomic<uint32_t>* counter) {
-    VASSERT(current_job_.has_value(), "Attempted to suspend a job without a current job");
-    for (int i = 0; i < 100; i++) {
-        if (counter->load() == 0) {
+void JobManager::park(ParkFn park_fn, void* context) {
+    VASSERT(current_job_ != nullptr, "Attempted to park a job without a current job");
+    VASSERT(!current_job_->leaf, "Leaf job {} attempted to suspend", current_job_->name);
+    log_trace("JobManager: Parking {}", current_job_->name);
+    post_scheduler_action.emplace(PostSchedulerAction::Type::Park, nullptr, park_fn, context);
+    switch_to_fiber(worker_fiber_);
+}
+
+void JobManager::ready_job(Job* job) {
+    push_ready_job(job);
+}
+
+bool JobManager::in_job() {
+    return get_current_job() != nullptr;
+}
+
+void JobManager::run_main_thread_jobs() {
+    VASSERT(state != nullptr, "run_main_thread_jobs called before JobManger was initialized");
+    Worker* worker = get_current_worker();
+    VASSERT(worker == state->main_worker && get_current_job() == nullptr, "run_main_thread_jobs must be called from the main thread outside of a job");
+
+    // Jobs that become ready in the meantime wait for the next call, so that a job that keeps
+    // yielding can't hold on to the main thread.
+    for (std::size_t budget = state->main_thread_jobs.size.load(std::memory_order_acquire); budget > 0; --budget) {
+        Job* job = pop_injected_job(state->main_thread_jobs);
+        if (job == nullptr) {
+            break;
+        }
+        run_job(*worker, job);
+        if (yielded_job_ != nullptr) {
+            push_ready_job(std::exchange(yielded_job_, nullptr));
+        }
+    }
+}
+
+void JobManager::wait_for_counter(JobCounter* counter, uint32_t target) {
+    VASSERT(get_current_job() == nullptr || !get_current_job()->leaf, "Leaf job {} attempted to wait for a counter", get_current_job()->name);
+    for (uint32_t i = 0; i < WAIT_SPIN_ATTEMPTS; i++) {
+        if (counter->has_reached(target)) {
             return;
         }
         _mm_pause();
     }
 
-    log_trace("JobManager: Suspending {} on counter (0x{})", current_job_->fiber.name, static_cast<void*>(counter));
-    post_scheduler_action.emplace(PostSchedulerAction::Type::Suspend, counter);
+    if (get_current_job() == nullptr) {
+        if (Worker* worker = get_current_worker(); worker != nullptr && worker == state->main_worker) {
+            help_until_reached(*worker, *counter, target);
+        } else {
+            while (!counter->has_reached(target)) {
+                std::this_thread::yield();
+            }
+        }
+        return;
+    }
+
+    log_trace("JobManager: Suspending {} on counter (0x{}) until it reaches {}", current_job_->name, static_cast<void*>(counter), target);
+    post_scheduler_action.emplace(PostSchedulerAction::Type::Suspend, counter, nullptr, nullptr, target);
     switch_to_fiber(worker_fiber_);
 }
 
+/**
+ * Log the peak stack usage of every job, warning about the ones that came close to overflowing.
+ */
+static void log_stack_usage() {
+    for (const JobStackUsage& usage : JobManager::stack_usage()) {
+        const std::size_t stack_bytes = JOB_STACK_SIZES[stack_size_index(usage.stack_size)];
+        if (usage.peak_bytes * 100 > stack_bytes * STACK_USAGE_WARNING_PERCENT) {
+            log_warning("Job {} used {} bytes of its {} byte stack", usage.name, usage.peak_bytes, stack_bytes);
+        } else {
+            log_debug("Job {} used {} bytes of its {} byte stack", usage.name, usage.peak_bytes, stack_bytes);
+        }
+    }
+}
+
 void JobManager::shutdown() {
     VASSERT(state != nullptr, "JobManager was already shutdown!");
+    VASSERT(get_current_worker() == state->main_worker && get_current_job() == nullptr, "JobManager must be shut down from the thread that initialized it");
 
     state->running = false;
 
+    for (auto& worker : state->workers | std::views::drop(1)) {
+        unpark_worker(*worker);
+    }
+    for (auto& worker : state->workers | std::views::drop(1)) {
+        worker->thread.join();
+    }
+    current_worker_ = nullptr;
+    convert_fiber_to_thread();
+    destroy_fiber(worker_fiber_);
+
+    std::size_t num_delayed_jobs = 0;
+    state->timers.clear([&num_delayed_jobs](Timer* timer) {
+        num_delayed_jobs += timer->period == 0 ? 1 : 0;
+        delete timer;
+    });
+    if (num_delayed_jobs > 0) {
+        log_warning("JobManager shut down with {} delayed jobs that never ran", num_delayed_jobs);
+    }
+
+    if constexpr (PAINT_FIBER_STACKS) {
+        log_stack_usage();
+    }
+
     for (auto& worker : state->workers) {
-        worker.join();
+        for (std::vector<Fiber*>& cache : worker->free_fibers) {
+            std::ranges::for_each(cache, destroy_pooled_fiber);
+        }
+    }
+    for (SharedPool<Fiber>& pool : state->fiber_pools) {
+        std::ranges::for_each(pool.free, destroy_pooled_fiber);
+    }
+    if (const std::size_t in_use = state->num_fibers.load(); in_use > 0) {
+        log_warning("JobManager shut down with {} job fibers still in use", in_use);
     }
 
+    for (auto& worker : state->workers) {
+        std::ranges::for_each(worker->free_jobs, [](Job* job) { delete job; });
+    }
+    std::ranges::for_each(state->job_pool.free, [](Job* job) { delete job; });
+
     delete state;
+    state = nullptr;
 }
 
-void JobManager::queue_job(JobDecl decl, std::atomic<uint32_t>* wait_counter) {
+void JobManager::queue_job(JobDecl decl, JobCounter* wait_counter, uint32_t wait_target) {
     VASSERT(state != nullptr, "queue_job called before JobManger was initialized");
 
-    Job job;
-    job.signal_counter = decl.signal_counter;
-    // TODO: Implement fiber pool and initialize job fibers in the scheduler for new jobs
-    job.fiber = create_fiber(reinterpret_cast<void (*)()>(job_main), decl.name);
-    job.fiber.context.arg = reinterpret_cast<uintptr_t>(decl.entry);
+    Job* job = acquire_job();
+    init_job(*job, std::move(decl));
+    if (job->signal_counter != nullptr) {
+        Job::add_to_counter(*job->signal_counter, 1);
+    }
+    add_pending_jobs(job->priority, 1);
 
-    if (job.signal_counter) {
-        job.signal_counter->fetch_add(1);
+    if (wait_counter == nullptr || !job->wait_on(*wait_counter, wait_target)) {
+        push_ready_job(job);
     }
+}
 
-    if (wait_counter == nullptr || wait_counter->load() == 0) {
-        std::lock_guard lock(state->queue_mutex);
-        state->fibers.push_back(job);
-    } else {
-        std::lock_guard lock(state->wait_mutex);
-        state->waiting_jobs.emplace_back(job, wait_counter);
+void JobManager::queue_job_after(std::chrono::nanoseconds delay, JobDecl decl) {
+    VASSERT(state != nullptr, "queue_job_after called before JobManger was initialized");
+
+    if (decl.signal_counter != nullptr) {
+        Job::add_to_counter(*decl.signal_counter, 1);
+    }
+    add_timer(new Timer{.decl = std::move(decl)}, delay);
+}
+
+PeriodicJobHandle JobManager::queue_periodic_job(std::chrono::nanoseconds period, JobDecl decl) {
+    VASSERT(state != nullptr, "queue_periodic_job called before JobManger was initialized");
+    VASSERT(period.count() > 0, "Periodic job {} needs a positive period", decl.name);
+
+    const auto period_ns = static_cast<uint64_t>(period.count());
+    auto* timer = new Timer{.decl = std::move(decl), .period = (period_ns + TIMER_TICK_NS - 1) / TIMER_TICK_NS};
+    PeriodicJobHandle handle;
+    {
+        std::lock_guard lock(state->timer_mutex);
+        handle.id = state->next_periodic_id++;
+        state->periodic_timers.emplace(handle.id, timer);
     }
+    add_timer(timer, period);
+    return handle;
 }
+
+void JobManager::cancel_periodic_job(PeriodicJobHandle handle) {
+    VASSERT(state != nullptr, "cancel_periodic_job called before JobManger was initialized");
+
+    std::lock_guard lock(state->timer_mutex);
+    if (const auto it = state->periodic_timers.find(handle.id); it != state->periodic_timers.end()) {
+        it->second->cancelled = true;
+        state->periodic_timers.erase(it);
+    }
+}
+
+void JobManager::queue_jobs(std::span<const JobDecl> decls, JobCounter* wait_counter, uint32_t wait_target) {
+    VASSERT(state != nullptr, "queue_jobs called before JobManger was initialized");
+
+    std::array<Job*, JOB_BATCH_BLOCK_SIZE> jobs;
+    for (std::size_t block_begin = 0; block_begin < decls.size(); block_begin += JOB_BATCH_BLOCK_SIZE) {
+        const std::span<const JobDecl> block = decls.subspan(block_begin, std::min(JOB_BATCH_BLOCK_SIZE, decls.size() - block_begin));
+
+        const std::span<Job*> block_jobs(jobs.data(), block.size());
+        acquire_jobs(block_jobs);
+
+        // Consecutive jobs usually share a counter, so update it once per run of jobs instead of
+        // once per job.
+        JobCounter* run_counter = nullptr;
+        uint32_t run_length = 0;
+        uint32_t num_critical = 0;
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            const JobDecl& decl = block[i];
+            Job* job = block_jobs[i];
+            job->name = decl.name;
+            job->entry = decl.entry;
+            job->signal_counter = decl.signal_counter;
+            job->priority = decl.priority;
+            job->main_thread_only = decl.main_thread_only;
+            job->leaf = decl.leaf;
+            job->stack_size = decl.stack_size;
+            num_critical += decl.priority == JobPriority::Critical ? 1 : 0;
+
+            if (decl.signal_counter != run_counter) {
+                if (run_counter != nullptr) {
+                    Job::add_to_counter(*run_counter, run_length);
+                }
+                run_counter = decl.signal_counter;
+                run_length = 0;
+            }
+            ++run_length;
+        }
+        if (run_counter != nullptr) {
+            Job::add_to_counter(*run_counter, run_length);
+        }
+        add_pending_jobs(JobPriority::Critical, num_critical);
+
+        if (wait_counter == nullptr || !Job::wait_on(*wait_counter, block_jobs, wait_target)) {
+            push_ready_jobs(block_jobs);
+        }
+    }
+}
+
+void JobManager::detail::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, RangeFn invoke, void* fn) {
+    VASSERT(state != nullptr, "parallel_for called before JobManger was initialized");
+    if (begin >= end) {
+        return;
+    }
+
+    const Job* caller = get_current_job();
+    ParallelFor parallel_for{
+        invoke,
+        fn,
+        std::max<std::size_t>(grain, 1),
+        caller != nullptr ? caller->priority : JobPriority::Normal,
+        caller != nullptr ? caller->stack_size : JobStackSize::Large,
+        {},
+    };
+
+    // Hand the range out in a few large pieces with a single push. Pieces are split further on
+    // demand by run_parallel_for_range.
+    const std::size_t num_chunks = (end - begin + parallel_for.grain - 1) / parallel_for.grain;
+    const std::size_t num_pieces = std::min(num_chunks, state->workers.size() * PARALLEL_FOR_PIECES_PER_WORKER);
+    const auto piece_bounds = [&](std::size_t piece) {
+        return std::pair{
+            begin + piece * num_chunks / num_pieces * parallel_for.grain,
+            std::min(begin + (piece + 1) * num_chunks / num_pieces * parallel_for.grain, end),
+        };
+    };
+
+    // A job runs the first piece itself rather than sitting idle while it waits
+    const bool in_job = caller != nullptr;
+    const std::size_t first_queued = in_job ? 1 : 0;
+    std::array<Job*, MAX_WORKERS * PARALLEL_FOR_PIECES_PER_WORKER> pieces;
+    const std::span<Job*> queued_pieces(pieces.data(), num_pieces - first_queued);
+    acquire_jobs(queued_pieces);
+    for (std::size_t i = 0; i < queued_pieces.size(); ++i) {
+        const auto [piece_begin, piece_end] = piece_bounds(first_queued + i);
+        init_parallel_for_job(*queued_pieces[i], parallel_for, piece_begin, piece_end);
+    }
+    Job::add_to_counter(parallel_for.counter, static_cast<uint32_t>(queued_pieces.size()));
+    add_pending_jobs(parallel_for.priority, static_cast<uint32_t>(queued_pieces.size()));
+    push_ready_jobs(queued_pieces);
+
+    if (in_job) {
+        const auto [piece_begin, piece_end] = piece_bounds(0);
+        run_parallel_for_range(parallel_for, piece_begin, piece_end);
+    }
+    wait_for_counter(&parallel_for.counter);
+}
+
+void JobManager::detail::add_to_counter(JobCounter& counter, uint32_t count) {
+    Job::add_to_counter(counter, count);
+}
+
+void JobManager::detail::signal_counter(JobCounter& counter) {
+    Job::signal(counter);
+}
+
 std::size_t JobManager::num_workers() {
     VASSERT(state != nullptr, "num_workers called before JobManger was initialized");
-    return state->workers.size();
+    return state->workers.size() - 1;
+}
+
+std::size_t JobManager::current_worker_index() {
+    const Worker* worker = get_current_worker();
+    VASSERT(worker != nullptr, "current_worker_index called from a thread that isn't a JobManager worker");
+    return worker->index;
+}
+
+FiberPoolStats JobManager::fiber_pool_stats() {
+    VASSERT(state != nullptr, "fiber_pool_stats called before JobManger was initialized");
+    FiberPoolStats stats;
+    for (const auto& worker : state->workers) {
+        stats.hits += worker->fiber_pool_hits.load(std::memory_order_relaxed);
+        stats.misses += worker->fiber_pool_misses.load(std::memory_order_relaxed);
+    }
+    stats.num_fibers = state->num_fibers.load(std::memory_order_relaxed);
+    stats.stack_bytes = state->num_stack_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<JobStackUsage> JobManager::stack_usage() {
+    VASSERT(state != nullptr, "stack_usage called before JobManger was initialized");
+    std::unordered_map<Name, JobStackUsage> merged;
+    for (const auto& worker : state->workers) {
+        std::lock_guard lock(worker->stack_usage_mutex);
+        for (const auto& [name, usage] : worker->stack_usage) {
+            JobStackUsage& merged_usage = merged.try_emplace(name, usage).first->second;
+            merged_usage.peak_bytes = std::max(merged_usage.peak_bytes, usage.peak_bytes);
+        }
+    }
+
+    std::vector<JobStackUsage> usages;
+    usages.reserve(merged.size());
+    for (const auto& usage : merged | std::views::values) {
+        usages.push_back(usage);
+    }
+    std::ranges::sort(usages, std::ranges::greater{}, &JobStackUsage::peak_bytes);
+    return usages;
+}
+
+JobManagerStats JobManager::stats() {
+    VASSERT(state != nullptr, "stats called before JobManger was initialized");
+    const uint64_t now = clock_ns();
+    JobManagerStats stats;
+    stats.elapsed_ns = now - state->start_time_ns;
+    stats.workers.reserve(state->workers.size());
+    for (const auto& worker : state->workers) {
+        WorkerStats& worker_stats = stats.workers.emplace_back();
+        worker_stats.jobs_run = worker->stats.jobs_run.load(std::memory_order_relaxed);
+        worker_stats.steals = worker->stats.steals.load(std::memory_order_relaxed);
+        worker_stats.suspends = worker->stats.suspends.load(std::memory_order_relaxed);
+        worker_stats.idle_ns = worker->stats.idle_ns.load(std::memory_order_relaxed);
+        // A worker that's been parked for a while would otherwise look busy until it wakes up
+        if (const uint64_t idle_since = worker->stats.idle_since_ns.load(std::memory_order_relaxed); idle_since != 0 && idle_since < now) {
+            worker_stats.idle_ns += now - idle_since;
+        }
+        for (std::size_t i = 0; i < NUM_QUEUE_LATENCY_BUCKETS; ++i) {
+            worker_stats.queue_latency[i] = worker->stats.queue_latency[i].load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+/**
+ * @return The upper bound in microseconds of the histogram bucket the given fraction of samples
+ * falls into.
+ */
+[[maybe_unused]] static int64_t queue_latency_percentile_us(const std::array<uint64_t, NUM_QUEUE_LATENCY_BUCKETS>& histogram, uint64_t num_samples, double fraction) {
+    const auto threshold = static_cast<uint64_t>(static_cast<double>(num_samples) * fraction);
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < NUM_QUEUE_LATENCY_BUCKETS; ++i) {
+        seen += histogram[i];
+        if (seen > threshold) {
+            return int64_t{1} << i;
+        }
+    }
+    return int64_t{1} << (NUM_QUEUE_LATENCY_BUCKETS - 1);
+}
+
+void JobManager::plot_stats() {
+    VASSERT(state != nullptr, "plot_stats called before JobManger was initialized");
+    if constexpr (COLLECT_STATS) {
+        JobManagerStats current = stats();
+        const JobManagerStats& last = state->last_plotted_stats;
+        const uint64_t elapsed_ns = current.elapsed_ns - last.elapsed_ns;
+
+        WorkerStats total;
+        for (std::size_t worker = 0; worker < current.workers.size(); ++worker) {
+            const WorkerStats& now = current.workers[worker];
+            const WorkerStats before = last.workers.empty() ? WorkerStats{} : last.workers[worker];
+            total.jobs_run += now.jobs_run - before.jobs_run;
+            total.steals += now.steals - before.steals;
+            total.suspends += now.suspends - before.suspends;
+            for (std::size_t i = 0; i < NUM_QUEUE_LATENCY_BUCKETS; ++i) {
+                total.queue_latency[i] += now.queue_latency[i] - before.queue_latency[i];
+            }
+
+            if (elapsed_ns > 0) {
+                const uint64_t idle_ns = std::min(now.idle_ns - std::min(before.idle_ns, now.idle_ns), elapsed_ns);
+                [[maybe_unused]] const double utilization = 100.0 * (1.0 - static_cast<double>(idle_ns) / static_cast<double>(elapsed_ns));
+                TracyPlot(state->utilization_plot_names[worker].c_str(), utilization);
+            }
+        }
+
+        TracyPlot("Jobs run", static_cast<int64_t>(total.jobs_run));
+        TracyPlot("Job steals", static_cast<int64_t>(total.steals));
+        TracyPlot("Job suspends", static_cast<int64_t>(total.suspends));
+        if (total.jobs_run > 0) {
+            TracyPlot("Job queue latency p50 (us)", queue_latency_percentile_us(total.queue_latency, total.jobs_run, 0.5));
+            TracyPlot("Job queue latency p99 (us)", queue_latency_percentile_us(total.queue_latency, total.jobs_run, 0.99));
+        }
+
+        state->last_plotted_stats = std::move(current);
+    }
 }
 } // namespace vee
@@ -13,14 +13,46 @@
 //    limitations under the License.
 
 
-#include "Assert.hpp"
 #include "Logging.hpp"
 
 
+#include <atomic>
+#include <cstdint>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
 #include <thread>
+#include <time.h>
+#include <unistd.h>
 
 namespace vee {
 void lock_thread_to_core(std::thread& thread, std::size_t core_num) {
-    VASSERT(false, "Not implemented");
+    if (core_num >= CPU_SETSIZE) {
+        log_error("Can't set affinity for core number greater than {}", CPU_SETSIZE);
+        return;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core_num, &cpu_set);
+    if (const int error = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set); error != 0) {
+        log_error("pthread_setaffinity_np failed for core {}. Error: {}", core_num, error);
+    }
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, uint64_t timeout_ns) {
+    const timespec timeout{
+        .tv_sec = static_cast<time_t>(timeout_ns / 1'000'000'000),
+        .tv_nsec = static_cast<long>(timeout_ns % 1'000'000'000),
+    };
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+}
+
+void futex_wake_one(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
 }
 } // namespace vee
@@ -18,6 +18,9 @@
 
 #include <Windows.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <thread>
 
 namespace vee {
@@ -30,4 +33,18 @@ void lock_thread_to_core(std::thread& thread, std::size_t core_num) {
         log_error("SetThreadAffinityMask failed for thread {} on core {}. GetLastError: {}", thread.native_handle(), core_num, GetLastError());
     }
 }
-} // namespace vee
\ No newline at end of file
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+}
+
+void futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, uint64_t timeout_ns) {
+    // Round up so that we never wake before the timeout
+    const auto timeout_ms = static_cast<DWORD>(std::min<uint64_t>((timeout_ns + 999'999) / 1'000'000, INFINITE - 1));
+    WaitOnAddress(&word, &expected, sizeof(expected), timeout_ms);
+}
+
+void futex_wake_one(std::atomic<uint32_t>& word) {
+    WakeByAddressSingle(&word);
+}
+} // namespace vee
@@ -0,0 +1,47 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+namespace vee {
+struct Job;
+
+/**
+ * Scheduler hooks for code that suspends jobs on something other than a JobCounter, such as the
+ * fiber synchronization primitives.
+ */
+namespace JobManager {
+    /**
+     * Called on the worker thread once the suspended job's fiber has been switched out, so the job
+     * can't be resumed twice even if it is made ready right away.
+     * @return false to resume the job immediately instead of leaving it suspended.
+     */
+    using ParkFn = bool (*)(Job* job, void* context);
+
+    /**
+     * Suspend the current job. park_fn decides where the job waits, and whoever takes it from there
+     * later must pass it to ready_job.
+     */
+    void park(ParkFn park_fn, void* context);
+    /**
+     * Make a job suspended by park runnable again.
+     */
+    void ready_job(Job* job);
+    /**
+     * @return True when called from inside a job, where park may be used.
+     */
+    bool in_job();
+} // namespace JobManager
+} // namespace vee
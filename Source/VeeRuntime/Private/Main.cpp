@@ -47,7 +47,11 @@ int main() {
     rdg::PassHandle frame_image_prev = "scene"_hash;
 #endif
 #if defined(TRACY_ENABLE) && !defined(TRACY_NO_FRAME_IMAGE)
-    rg.add_pass<rdg::FrameImageRenderPass>("frame_image"_hash).link_sink({frame_image_prev, "render_target"_hash}, "copy_source"_hash);
+    rg.add_transient_image("frame_image_small"_hash, {rdg::DebugScreen::WIDTH, rdg::DebugScreen::HEIGHT, vk::Format::eR8G8B8A8Srgb});
+    rg.add_pass<rdg::FrameImageRenderPass>("frame_image"_hash)
+        .link_sink({frame_image_prev, "render_target"_hash}, "copy_source"_hash)
+        .link_sink({rdg::GLOBAL, "frame_image_small"_hash}, "copy_dest"_hash);
+    rg.add_pass<rdg::FrameImageReadbackPass>("frame_image_readback"_hash).link_sink({"frame_image"_hash, "copy_dest"_hash}, "copy_source"_hash);
 #endif
 
     auto window = platform::Window::create(g_game_info.game_name, 640, 640);
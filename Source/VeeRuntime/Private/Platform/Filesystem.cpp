@@ -15,6 +15,8 @@
 
 #include "Platform/Filesystem.hpp"
 
+#include "JobManager.hpp"
+
 #include <fstream>
 
 namespace vee::platform::filesystem {
@@ -29,4 +31,12 @@ std::vector<std::byte> read_binary_file(const char* filename) {
 
     return result;
 }
-} // namespace vee::platform::filesystem
\ No newline at end of file
+
+Task<std::optional<std::vector<std::byte>>> read_binary_file_task(std::string filename) {
+    std::optional<std::vector<std::byte>> result;
+    JobCounter read_done;
+    JobManager::queue_job({"read_binary_file"_hash, [&] { result = read_binary_file_async(filename.c_str()); }, &read_done});
+    co_await read_done;
+    co_return result;
+}
+} // namespace vee::platform::filesystem
@@ -0,0 +1,432 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Platform/Filesystem.hpp"
+
+#include "Assert.hpp"
+#include "FiberSync.hpp"
+#include "JobScheduler.hpp"
+#include "Logging.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace vee::platform::filesystem {
+constexpr static uint32_t RING_ENTRIES = 256;
+// Larger files are read in several requests
+constexpr static std::size_t MAX_READ_SIZE = 64 * 1024 * 1024;
+
+/**
+ * A read that is in flight. Lives on the stack of the suspended job.
+ */
+struct PendingRead {
+    Job* job = nullptr;
+    int fd = -1;
+    std::byte* buffer = nullptr;
+    uint32_t size = 0;
+    uint64_t offset = 0;
+    int32_t result = 0;
+    // Links in AsyncIoState::pending
+    PendingRead* prev = nullptr;
+    PendingRead* next = nullptr;
+    // While submit_read is still handing the read to the kernel, only submit_read may resume the
+    // job. A completion that arrives in the meantime only sets completed.
+    bool submitting = false;
+    bool completed = false;
+};
+
+/**
+ * Minimal io_uring setup on top of the raw syscalls. Submissions are serialized by a mutex, and a
+ * single poller thread reaps completions.
+ */
+struct IoUring {
+    int fd = -1;
+    uint32_t sq_entries = 0;
+
+    void* sq_ring = nullptr;
+    std::size_t sq_ring_size = 0;
+    uint32_t* sq_head = nullptr;
+    uint32_t* sq_tail = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t* sq_array = nullptr;
+    io_uring_sqe* sqes = nullptr;
+
+    void* cq_ring = nullptr;
+    std::size_t cq_ring_size = 0;
+    uint32_t* cq_head = nullptr;
+    uint32_t* cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+struct AsyncIoState {
+    IoUring ring;
+    std::mutex submit_mutex;
+    std::thread poller;
+    // Keeps the number of reads in flight below the completion queue size, so completions are never
+    // dropped.
+    FiberSemaphore in_flight{RING_ENTRIES};
+
+    // Reads handed to the kernel that haven't completed yet, so that they can be failed if the
+    // poller stops
+    std::mutex pending_mutex;
+    PendingRead* pending = nullptr;
+    // Set once the poller stopped reaping completions, reads fail right away from then on
+    bool failed = false;
+};
+
+static AsyncIoState* state = nullptr;
+
+template <typename T>
+static T* ring_field(void* ring, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<std::byte*>(ring) + offset);
+}
+
+static bool setup_ring(IoUring& ring, uint32_t entries) {
+    io_uring_params params = {};
+    const auto fd = static_cast<int>(syscall(SYS_io_uring_setup, entries, &params));
+    if (fd < 0) {
+        log_warning("io_uring_setup failed: {}", std::strerror(errno));
+        return false;
+    }
+    ring.fd = fd;
+    ring.sq_entries = params.sq_entries;
+
+    ring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring.sq_ring_size = ring.cq_ring_size = std::max(ring.sq_ring_size, ring.cq_ring_size);
+    }
+
+    ring.sq_ring = mmap(nullptr, ring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring.cq_ring = single_mmap ? ring.sq_ring : mmap(nullptr, ring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring.sq_ring == MAP_FAILED || ring.cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+        log_warning("Failed to map io_uring queues: {}", std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    ring.sq_head = ring_field<uint32_t>(ring.sq_ring, params.sq_off.head);
+    ring.sq_tail = ring_field<uint32_t>(ring.sq_ring, params.sq_off.tail);
+    ring.sq_mask = *ring_field<uint32_t>(ring.sq_ring, params.sq_off.ring_mask);
+    ring.sq_array = ring_field<uint32_t>(ring.sq_ring, params.sq_off.array);
+    ring.sqes = static_cast<io_uring_sqe*>(sqes);
+
+    ring.cq_head = ring_field<uint32_t>(ring.cq_ring, params.cq_off.head);
+    ring.cq_tail = ring_field<uint32_t>(ring.cq_ring, params.cq_off.tail);
+    ring.cq_mask = *ring_field<uint32_t>(ring.cq_ring, params.cq_off.ring_mask);
+    ring.cqes = ring_field<io_uring_cqe>(ring.cq_ring, params.cq_off.cqes);
+    return true;
+}
+
+static void destroy_ring(IoUring& ring) {
+    munmap(ring.sqes, ring.sq_entries * sizeof(io_uring_sqe));
+    if (ring.cq_ring != ring.sq_ring) {
+        munmap(ring.cq_ring, ring.cq_ring_size);
+    }
+    munmap(ring.sq_ring, ring.sq_ring_size);
+    close(ring.fd);
+}
+
+/**
+ * Queue a request and submit it to the kernel.
+ * @param prepare Fills in the submission queue entry.
+ */
+template <typename Fn>
+static int submit(IoUring& ring, Fn&& prepare) {
+    std::lock_guard lock(state->submit_mutex);
+    // Every submission is handed to the kernel right away, so there's always a free entry
+    const uint32_t tail = *ring.sq_tail;
+    VASSERT(tail - std::atomic_ref(*ring.sq_head).load(std::memory_order_acquire) < ring.sq_entries, "io_uring submission queue is full");
+
+    const uint32_t index = tail & ring.sq_mask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    prepare(sqe);
+    ring.sq_array[index] = index;
+    std::atomic_ref(*ring.sq_tail).store(tail + 1, std::memory_order_release);
+
+    int error = 0;
+    while (syscall(SYS_io_uring_enter, ring.fd, 1, 0, 0, nullptr, 0) < 0) {
+        error = errno;
+        if (error == EAGAIN || error == EBUSY) {
+            // Out of kernel memory or too many completions backed up, give the poller a chance to
+            // reap some
+            std::this_thread::yield();
+        } else if (error != EINTR) {
+            break;
+        }
+        error = 0;
+    }
+
+    // The entry is published, so a later submit would hand it to the kernel after all. Take it
+    // back unless the kernel consumed it anyway.
+    if (error != 0 && std::atomic_ref(*ring.sq_head).load(std::memory_order_acquire) == tail) {
+        std::atomic_ref(*ring.sq_tail).store(tail, std::memory_order_release);
+        return -error;
+    }
+    return 0;
+}
+
+static void link_pending(AsyncIoState& io, PendingRead& read) {
+    read.prev = nullptr;
+    read.next = io.pending;
+    if (io.pending != nullptr) {
+        io.pending->prev = &read;
+    }
+    io.pending = &read;
+}
+
+static void unlink_pending(AsyncIoState& io, PendingRead& read) {
+    if (read.prev != nullptr) {
+        read.prev->next = read.next;
+    } else {
+        io.pending = read.next;
+    }
+    if (read.next != nullptr) {
+        read.next->prev = read.prev;
+    }
+}
+
+/**
+ * Complete a read and resume its job. The read may be gone as soon as the job is ready.
+ */
+static void finish_read(AsyncIoState& io, PendingRead& read, int32_t result) {
+    read.result = result;
+    Job* job = read.job;
+    io.in_flight.release();
+    JobManager::ready_job(job);
+}
+
+/**
+ * Fail every outstanding read and every read started later, once nothing reaps completions
+ * anymore.
+ */
+static void fail_pending_reads(AsyncIoState& io, int32_t error) {
+    std::lock_guard lock(io.pending_mutex);
+    io.failed = true;
+    for (PendingRead* read = io.pending; read != nullptr;) {
+        PendingRead* next = read->next;
+        // submit_read fails these itself once it sees failed
+        if (!read->submitting) {
+            unlink_pending(io, *read);
+            finish_read(io, *read, error);
+        }
+        read = next;
+    }
+}
+
+/**
+ * Park function for reads. Runs once the job's fiber has been switched out, so the poller can
+ * safely resume it as soon as the read completes.
+ */
+static bool submit_read(Job* job, void* context) {
+    PendingRead& read = *static_cast<PendingRead*>(context);
+    read.job = job;
+
+    {
+        std::lock_guard lock(state->pending_mutex);
+        if (state->failed) {
+            read.result = -EIO;
+            state->in_flight.release();
+            return false;
+        }
+        read.submitting = true;
+        link_pending(*state, read);
+    }
+
+    // Not under pending_mutex, submit may have to wait for the poller to reap completions
+    const int error = submit(state->ring, [&](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = read.fd;
+        sqe.addr = reinterpret_cast<uint64_t>(read.buffer);
+        sqe.len = read.size;
+        sqe.off = read.offset;
+        sqe.user_data = reinterpret_cast<uint64_t>(&read);
+    });
+
+    std::lock_guard lock(state->pending_mutex);
+    read.submitting = false;
+    if (read.completed) {
+        // The poller already reaped the read and left resuming the job to us
+        state->in_flight.release();
+        return false;
+    }
+    if (error != 0 || state->failed) {
+        // Either the read never reached the kernel or nothing will reap it anymore, resume the job
+        // with the error
+        if (error != 0) {
+            log_error("io_uring_enter failed: {}", std::strerror(-error));
+        }
+        unlink_pending(*state, read);
+        read.result = error != 0 ? error : -EIO;
+        state->in_flight.release();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @param io Passed in rather than read from state, shutdown_async_io may leave a poller that
+ * never got the shutdown request behind.
+ */
+static void poller_main(AsyncIoState* io) {
+    tracy::SetThreadName("I/O completions");
+    IoUring& ring = io->ring;
+
+    bool running = true;
+    while (running) {
+        int error = 0;
+        if (syscall(SYS_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+            error = errno;
+            // The completion queue overflowing or a lack of kernel memory pass once completions
+            // are reaped
+            if (error == EINTR || error == EAGAIN || error == EBUSY) {
+                error = 0;
+            }
+        }
+
+        uint32_t head = *ring.cq_head;
+        const uint32_t tail = std::atomic_ref(*ring.cq_tail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+            // A request without a read attached is the shutdown signal
+            if (cqe.user_data == 0) {
+                running = false;
+                continue;
+            }
+
+            // The read lives on the job's stack and may be gone as soon as the job is ready
+            auto& read = *reinterpret_cast<PendingRead*>(cqe.user_data);
+            {
+                std::lock_guard lock(io->pending_mutex);
+                unlink_pending(*io, read);
+                if (read.submitting) {
+                    read.result = cqe.res;
+                    read.completed = true;
+                    continue;
+                }
+            }
+            finish_read(*io, read, cqe.res);
+        }
+        std::atomic_ref(*ring.cq_head).store(head, std::memory_order_release);
+
+        if (error != 0) {
+            log_error("io_uring_enter failed while waiting for completions: {}", std::strerror(error));
+            fail_pending_reads(*io, -error);
+            break;
+        }
+    }
+}
+
+void init_async_io() {
+    VASSERT(state == nullptr, "Async I/O was already initialized");
+    auto* new_state = new AsyncIoState();
+    if (!setup_ring(new_state->ring, RING_ENTRIES)) {
+        log_warning("io_uring is unavailable, asynchronous reads will block their worker");
+        delete new_state;
+        return;
+    }
+    state = new_state;
+    state->poller = std::thread(poller_main, state);
+}
+
+void shutdown_async_io() {
+    if (state == nullptr) {
+        return;
+    }
+
+    const int error = submit(state->ring, [](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_NOP;
+        sqe.user_data = 0;
+    });
+    if (error != 0) {
+        // The poller never sees the shutdown request. Leave it and the ring it waits on behind
+        // rather than block on it forever.
+        log_error("Failed to stop the I/O completion thread: {}", std::strerror(-error));
+        state->poller.detach();
+        state = nullptr;
+        return;
+    }
+    state->poller.join();
+    destroy_ring(state->ring);
+    delete state;
+    state = nullptr;
+}
+
+/**
+ * @return The number of bytes read, or a negative errno value.
+ */
+static int64_t read_at(int fd, std::byte* buffer, std::size_t size, uint64_t offset) {
+    if (state == nullptr || !JobManager::in_job()) {
+        const ssize_t result = pread(fd, buffer, size, static_cast<off_t>(offset));
+        return result < 0 ? -errno : result;
+    }
+
+    state->in_flight.acquire();
+    PendingRead read{.fd = fd, .buffer = buffer, .size = static_cast<uint32_t>(size), .offset = offset};
+    JobManager::park(&submit_read, &read);
+    return read.result;
+}
+
+std::optional<std::vector<std::byte>> read_binary_file_async(const char* filename) {
+    ZoneScoped;
+    const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_error("Failed to open \"{}\": {}", filename, std::strerror(errno));
+        return std::nullopt;
+    }
+
+    struct stat file_stat = {};
+    if (fstat(fd, &file_stat) != 0) {
+        log_error("Failed to stat \"{}\": {}", filename, std::strerror(errno));
+        close(fd);
+        return std::nullopt;
+    }
+
+    std::vector<std::byte> result(static_cast<std::size_t>(file_stat.st_size));
+    std::size_t offset = 0;
+    while (offset < result.size()) {
+        const int64_t bytes_read = read_at(fd, result.data() + offset, std::min(result.size() - offset, MAX_READ_SIZE), offset);
+        if (bytes_read == -EINTR || bytes_read == -EAGAIN) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            log_error("Failed to read \"{}\": {}", filename, bytes_read == 0 ? "unexpected end of file" : std::strerror(static_cast<int>(-bytes_read)));
+            close(fd);
+            return std::nullopt;
+        }
+        offset += static_cast<std::size_t>(bytes_read);
+    }
+
+    close(fd);
+    return result;
+}
+} // namespace vee::platform::filesystem
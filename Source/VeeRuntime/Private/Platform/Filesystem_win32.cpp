@@ -0,0 +1,45 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Platform/Filesystem.hpp"
+
+#include "Logging.hpp"
+
+#include <fstream>
+
+namespace vee::platform::filesystem {
+// TODO: Back this with overlapped reads on an I/O completion port that resumes the waiting job, the
+// same way the io_uring backend does on Linux. Until then, reads block the calling worker.
+void init_async_io() {}
+
+void shutdown_async_io() {}
+
+std::optional<std::vector<std::byte>> read_binary_file_async(const char* filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        log_error("Failed to open \"{}\"", filename);
+        return std::nullopt;
+    }
+
+    const std::streampos file_size = file.tellg();
+    std::vector<std::byte> result(static_cast<std::size_t>(file_size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(result.data()), file_size)) {
+        log_error("Failed to read \"{}\"", filename);
+        return std::nullopt;
+    }
+    return result;
+}
+} // namespace vee::platform::filesystem
@@ -46,12 +46,16 @@ Sink* Pass::find_sink(SinkHandle handle) const {
     return sink_entry->second.get();
 }
 
-void Pass::register_source(SourceHandle name, std::unique_ptr<Source> source) {
+void Pass::register_source(SourceHandle name, std::unique_ptr<Source> source, ResourceUsage usage) {
     VASSERT(!sources_.contains(name), "Cannot register more than one source with the same name!");
+    VASSERT(usage == ResourceUsage::None || !source->resource().empty(), "Source {} has no image or buffer to use", name.to_string());
+    source->usage = usage;
     sources_.insert({name, std::move(source)});
 }
-void Pass::register_sink(SinkHandle name, std::unique_ptr<Sink> sink) {
+void Pass::register_sink(SinkHandle name, std::unique_ptr<Sink> sink, ResourceUsage usage) {
     VASSERT(!sinks_.contains(name), "Cannot register more than one sink with the same name!");
+    VASSERT(usage == ResourceUsage::None || !sink->resource().empty(), "Sink {} has no image or buffer to use", name.to_string());
+    sink->usage = usage;
     sinks_.insert({name, std::move(sink)});
 }
 
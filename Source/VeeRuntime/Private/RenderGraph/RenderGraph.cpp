@@ -16,11 +16,17 @@
 #include "RenderGraph/RenderGraph.hpp"
 
 #include "Assert.hpp"
+#include "FrameMemory.hpp"
+#include "JobManager.hpp"
+#include "Logging.hpp"
 #include "Renderer/RenderCtx.hpp"
 #include "RenderGraph/DirectSink.hpp"
 #include "RenderGraph/ImageResource.hpp"
 #include "RenderGraph/Pass.hpp"
+#include "RenderGraph/ResourceStateTracker.hpp"
+#include "RenderGraph/SecondaryCommandPools.hpp"
 #include "RenderGraph/Source.hpp"
+#include "RenderGraph/TransientImagePool.hpp"
 #include "Vertex.hpp"
 
 // TODO: Remove this after refactoring Tracy Image upload into this pass
@@ -28,9 +34,12 @@
 #include "IApplication.hpp"
 #include "Renderer.hpp"
 
+#include <algorithm>
 #include <entt/locator/locator.hpp>
+#include <memory_resource>
 #include <numbers>
 #include <ranges>
+#include <span>
 #include <tracy/Tracy.hpp>
 
 namespace vee::rdg {
@@ -40,9 +49,53 @@ struct null_deleter {
     template <typename T>
     void operator()(T*) const {}
 };
-RenderGraph::RenderGraph(std::unordered_map<PassHandle, std::unique_ptr<Pass>>&& passes, std::vector<PassHandle>&& pass_order, RenderCtx& render_ctx)
+
+namespace {
+const Name RECORD_PASS_JOB_NAME = "record_pass"_hash;
+
+struct PassRecording {
+    Pass* pass;
+    std::size_t num_chunks;
+    ChunkedRendering rendering;
+    // Index of the Pass's first secondary command buffer
+    std::size_t first_secondary;
+};
+
+vk::CommandBuffer record_secondary(SecondaryCommandPools& pools, const PassRecording& recording, std::size_t chunk) {
+    const vk::CommandBuffer cmd = pools.allocate();
+    if (recording.num_chunks == 1) {
+        const vk::CommandBufferInheritanceInfo inheritance = {};
+        std::ignore = cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit, &inheritance});
+        recording.pass->execute(cmd);
+    } else {
+        // Chunks continue the rendering the primary command buffer begins around them
+        const ChunkedRendering& rendering = recording.rendering;
+        const vk::CommandBufferInheritanceRenderingInfo rendering_inheritance = {
+            rendering.info.flags, rendering.info.viewMask, static_cast<uint32_t>(rendering.color_formats.size()), rendering.color_formats.data()
+        };
+        const vk::CommandBufferInheritanceInfo inheritance = {{}, 0, {}, {}, {}, {}, &rendering_inheritance};
+        std::ignore = cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &inheritance});
+        recording.pass->execute_chunk(cmd, chunk, recording.num_chunks);
+    }
+    std::ignore = cmd.end();
+    return cmd;
+}
+} // namespace
+
+RenderGraph::RenderGraph(
+    std::vector<std::unique_ptr<Pass>>&& passes,
+    RenderGraphSchedule&& schedule,
+    std::span<const std::pair<SinkHandle, TransientImageDesc>> transient_images,
+    RenderCtx& render_ctx
+)
     : passes_(std::move(passes))
-    , pass_order_(std::move(pass_order)) {
+    , schedule_(std::move(schedule))
+    , resource_states_(std::make_unique<ResourceStateTracker>()) {
+    VASSERT(passes_.size() == schedule_.pass_order.size(), "RenderGraph got {} passes for a schedule of {}", passes_.size(), schedule_.pass_order.size());
+    for (std::size_t i = 0; i < schedule_.pass_order.size(); ++i) {
+        pass_indices_.insert({schedule_.pass_order[i], i});
+    }
+
     {
         const vk::SemaphoreTypeCreateInfo tci{vk::SemaphoreType::eTimeline, 0};
         const vk::SemaphoreCreateInfo ci{{}, &tci};
@@ -59,22 +112,102 @@ RenderGraph::RenderGraph(std::unordered_map<PassHandle, std::unique_ptr<Pass>>&&
     global_sinks_.insert({"vertex_buffer"_hash, DirectSink<Buffer>::make(vertex_buffer_)});
     global_sinks_.insert({"index_buffer"_hash, DirectSink<Buffer>::make(index_buffer_)});
 
-    // TODO: Topological sort before this, validate topology, etc.
-    for (auto& pass_handle : pass_order_) {
-        auto& pass = passes_.at(pass_handle);
-        for (const auto& sink : pass->iterate_sinks()) {
+    // Transient images get their memory once their uses are known, the sinks only hand out the
+    // ImageResource that select_frame fills in
+    transient_image_resources_.reserve(transient_images.size());
+    for (const auto& [name, desc] : transient_images) {
+        VASSERT(!global_sinks_.contains(name), "Transient image {} has the name of a global sink", name.to_string());
+        global_sinks_.insert({name, DirectSink<ImageResource>::make(transient_image_resources_.emplace_back(std::make_shared<ImageResource>()))});
+    }
+
+    // The schedule runs every Pass after the Passes it links to, so Sinks are always initialized
+    // before the Sources linked to them are resolved. Links between Passes were validated by the
+    // RenderGraphBuilder, only links to global Sinks are left to check.
+    for (std::size_t i = 0; i < passes_.size(); ++i) {
+        for (const auto& sink : passes_[i]->iterate_sinks()) {
             sink->init(render_ctx);
         }
-        for (const auto& source : pass->iterate_sources()) {
+        for (const auto& source : passes_[i]->iterate_sources()) {
+            VASSERT(find_sink(source->sink_ref) != nullptr, "Pass {} links to missing sink {}", schedule_.pass_order[i].to_string(), source->sink_ref.sink.to_string());
             source->resolve(*this);
         }
     }
+
+    // Collect the declared resource uses and the Sinks to prepare once, so that execute never has
+    // to walk the Sources and Sinks of every Pass
+    for (const auto& pass : passes_) {
+        for (const auto& source : pass->iterate_sources()) {
+            if (source->usage != ResourceUsage::None) {
+                accesses_.push_back({source->resource(), source->usage});
+            }
+        }
+        for (const auto& sink : pass->iterate_sinks()) {
+            if (sink->usage != ResourceUsage::None) {
+                accesses_.push_back({sink->resource(), sink->usage});
+            }
+            if (sink->prepare_every_frame) {
+                prepared_sinks_.push_back(sink.get());
+            }
+        }
+        access_offsets_.push_back(accesses_.size());
+    }
+
+#if defined(TRACY_ENABLE) && !(TRACY_NO_FRAME_IMAGE)
+    // FIXME: This also needs to be controlled from the Debug/FrameImagePass somehow
+    if (pass_indices_.contains("frame_image_readback"_hash)) {
+        frame_image_sink_ = dynamic_cast<CopyBufferSink*>(find_sink({"frame_image_readback"_hash, "copy_buffer"_hash}));
+        VASSERT(frame_image_sink_ != nullptr, "frame_image_readback has no copy_buffer sink");
+    }
+#endif
+
+    create_transient_images(transient_images, render_ctx);
+}
+
+void RenderGraph::create_transient_images(std::span<const std::pair<SinkHandle, TransientImageDesc>> transient_images, RenderCtx& render_ctx) {
+    // A transient image is alive from the first to the last Pass with a Source or Sink resolved to
+    // it, and needs the usage flags of every use declared on them
+    std::vector<TransientImagePool::Image> images;
+    for (std::size_t t = 0; t < transient_images.size(); ++t) {
+        TransientImagePool::Image image = {transient_image_resources_[t], transient_images[t].second, {}, SIZE_MAX, 0};
+        const auto add_use = [&](ResourceRef ref, ResourceUsage usage, std::size_t pass_index) {
+            if (ref.image != nullptr && ref.image->get() == image.resource.get()) {
+                image.usage |= TransientImagePool::usage_flags(usage);
+                image.first_use = std::min(image.first_use, pass_index);
+                image.last_use = pass_index;
+            }
+        };
+        for (std::size_t i = 0; i < passes_.size(); ++i) {
+            for (const auto& source : passes_[i]->iterate_sources()) {
+                add_use(source->resource(), source->usage, i);
+            }
+            for (const auto& sink : passes_[i]->iterate_sinks()) {
+                add_use(sink->resource(), sink->usage, i);
+            }
+        }
+
+        if (image.first_use == SIZE_MAX) {
+            log_warning("Transient image {} is never used", transient_images[t].first.to_string());
+            continue;
+        }
+        VASSERT(image.usage, "No pass declares how it uses transient image {}", transient_images[t].first.to_string());
+        images.push_back(std::move(image));
+    }
+
+    // One set of images per command buffer, a set is only reused once its command buffer's fence
+    // was waited on
+    transient_images_ = std::make_unique<TransientImagePool>(render_ctx, std::move(images), render_ctx.command_buffers.size());
+    const TransientMemoryStats stats = transient_images_->stats();
+    log_info("RenderGraph transient images take {} bytes per frame in flight, {} without aliasing", stats.aliased_bytes, stats.unaliased_bytes);
+}
+
+TransientMemoryStats RenderGraph::transient_memory_stats() const {
+    return transient_images_->stats();
 }
 RenderGraph::RenderGraph(RenderGraph&& other) = default;
 RenderGraph& RenderGraph::operator=(RenderGraph&& other) = default;
 
 RenderGraph::~RenderGraph() = default;
-void RenderGraph::execute(RenderCtx& render_ctx) const {
+void RenderGraph::execute(RenderCtx& render_ctx) {
     ZoneScoped;
     const Renderer& renderer = entt::locator<IApplication>::value().get_renderer();
     const uint64_t frame_num_ = renderer.get_frame_number();
@@ -83,7 +216,7 @@ void RenderGraph::execute(RenderCtx& render_ctx) const {
     // Let's upload the image now for the frame three frames ago.
     // TODO: Jobify this, do it asynchronously.
     const std::size_t frames_in_flight = render_ctx.swapchain.images.size();
-    if (frame_num_ > frames_in_flight) {
+    if (frame_image_sink_ != nullptr && frame_num_ > frames_in_flight) {
         const std::size_t data_frame = frame_num_ - frames_in_flight;
         {
             ZoneScopedN("Wait for Frame Image");
@@ -92,9 +225,7 @@ void RenderGraph::execute(RenderCtx& render_ctx) const {
         }
         {
             ZoneScopedN("Upload Frame Image");
-            // FIXME: This also needs to be controlled from the Debug/FrameImagePass somehow
-            Sink* debug_sink = find_sink({"frame_image"_hash, "copy_buffer"_hash});
-            void* image_data = dynamic_cast<CopyBufferSink*>(debug_sink)->target->mem;
+            void* image_data = frame_image_sink_->target->mem;
             FrameImage(image_data, DebugScreen::WIDTH, DebugScreen::HEIGHT, -frames_in_flight, false);
         }
     }
@@ -127,6 +258,12 @@ void RenderGraph::execute(RenderCtx& render_ctx) const {
     }
     VASSERT(image_index != UINT32_MAX, "failed to acquire image index");
     std::ignore = render_ctx.device.resetFences(command_buffer.fence);
+    const std::size_t frame = static_cast<std::size_t>(&command_buffer - render_ctx.command_buffers.buffer.data());
+    transient_images_->select_frame(frame);
+    if (!secondary_pools_) {
+        secondary_pools_ = std::make_unique<SecondaryCommandPools>(render_ctx, render_ctx.command_buffers.size(), JobManager::num_workers() + 1);
+    }
+    secondary_pools_->begin_frame(frame);
 
     // Submit semaphore needs to be moved out of the host-side resource ring buffer because it can't
     // be determined which semaphore to use until after a swapchain image index has been acquired
@@ -140,61 +277,89 @@ void RenderGraph::execute(RenderCtx& render_ctx) const {
     framebuffer_->view = swapchain.image_views[image_index];
     framebuffer_->width = swapchain.width;
     framebuffer_->height = swapchain.height;
+    framebuffer_->format = swapchain.format;
 
-    for (auto& pass_handle : pass_order_) {
-        auto& pass = passes_.at(pass_handle);
-        for (const auto& sink : pass->iterate_sinks()) {
-            sink->prepare(*this);
+    for (Sink* sink : prepared_sinks_) {
+        sink->prepare(*this);
+    }
+
+    // Every Pass records into its own secondary command buffer, or one per chunk for split Passes.
+    // Recording order doesn't matter to the GPU, so all Passes record at once rather than level by
+    // level, and the primary command buffer executes them in schedule order.
+    std::pmr::vector<PassRecording> recordings(FrameMemory::resource());
+    recordings.reserve(passes_.size());
+    std::size_t num_secondaries = 0;
+    for (std::size_t i = 0; i < passes_.size(); ++i) {
+        Pass* pass = passes_[i].get();
+        const std::size_t num_chunks = pass->prepare_chunks();
+        VASSERT(num_chunks > 0, "Pass {} has no chunks to record", schedule_.pass_order[i].to_string());
+        recordings.push_back({pass, num_chunks, num_chunks > 1 ? pass->chunk_rendering() : ChunkedRendering{}, num_secondaries});
+        num_secondaries += num_chunks;
+    }
+
+    std::pmr::vector<vk::CommandBuffer> secondaries(num_secondaries, FrameMemory::resource());
+    {
+        ZoneScopedN("Record passes");
+        JobCounter counter;
+        std::pmr::vector<JobDecl> jobs(FrameMemory::resource());
+        jobs.reserve(num_secondaries);
+        // The jobs point into recordings and secondaries, which belong to this call on the main
+        // thread. That is only safe because every job is waited for right below, so don't turn the
+        // wait into a deferred join.
+        for (const PassRecording& recording : recordings) {
+            for (std::size_t chunk = 0; chunk < recording.num_chunks; ++chunk) {
+                jobs.push_back({
+                    RECORD_PASS_JOB_NAME,
+                    [pools = secondary_pools_.get(), &recording, &secondaries, chunk] {
+                        secondaries[recording.first_secondary + chunk] = record_secondary(*pools, recording, chunk);
+                    },
+                    &counter,
+                    JobPriority::Critical,
+                    recording.pass->is_main_thread_only(),
+                    true,
+                });
+            }
         }
+        JobManager::queue_jobs(jobs);
+        JobManager::wait_for_counter(&counter);
     }
 
 
     vk::CommandBuffer cmd = command_buffer.cmd;
     std::ignore = cmd.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
     std::ignore = cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
-    {
-        const vk::ImageMemoryBarrier2 image_barrier = {
-            vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-            vk::AccessFlagBits2::eNone,
-            vk::PipelineStageFlagBits2::eAllGraphics,
-            vk::AccessFlagBits2::eColorAttachmentWrite,
-            vk::ImageLayout::eUndefined,
-            vk::ImageLayout::eColorAttachmentOptimal,
-            {},
-            {},
-            framebuffer_->image,
-            {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
-        };
 
-        vk::DependencyInfo dependency_info;
-        dependency_info.setImageMemoryBarriers(image_barrier);
-        cmd.pipelineBarrier2(dependency_info);
-    }
-    for (const auto& pass_handle : pass_order_) {
-        const auto& pass = passes_.at(pass_handle);
-        // TODO: Insert image transitions based on Sink's current usage
-        // for (const auto& sink : pass->sinks) {
-        // }
-        pass->execute(cmd);
+    // The framebuffer's first transition has to wait for the acquire semaphore, and transient
+    // images for whatever used their memory before them
+    resource_states_->reset();
+    resource_states_->set_initial_stages(framebuffer_->image, vk::PipelineStageFlagBits2::eColorAttachmentOutput);
+    for (const vk::Image image : transient_images_->aliased_images()) {
+        resource_states_->set_initial_stages(image, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eMemoryWrite);
     }
-    {
-        const vk::ImageMemoryBarrier2 image_barrier[] = {
-            {vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-             vk::AccessFlagBits2::eColorAttachmentWrite,
-             vk::PipelineStageFlagBits2::eNone,
-             vk::AccessFlagBits2::eNone,
-             vk::ImageLayout::eColorAttachmentOptimal,
-             vk::ImageLayout::ePresentSrcKHR,
-             {},
-             {},
-             framebuffer_->image,
-             {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}},
-        };
+    for (std::size_t i = 0; i < passes_.size(); ++i) {
+        for (const ResourceAccess& access : pass_accesses(i)) {
+            if (access.resource.image != nullptr) {
+                resource_states_->use((*access.resource.image)->image, access.usage);
+            } else {
+                resource_states_->use((*access.resource.buffer)->buffer, access.usage);
+            }
+        }
+        resource_states_->flush(cmd);
 
-        vk::DependencyInfo dependency_info;
-        dependency_info.setImageMemoryBarriers(image_barrier);
-        cmd.pipelineBarrier2(dependency_info);
+        const PassRecording& recording = recordings[i];
+        const std::span<const vk::CommandBuffer> pass_secondaries = std::span(secondaries).subspan(recording.first_secondary, recording.num_chunks);
+        if (recording.num_chunks == 1) {
+            cmd.executeCommands(pass_secondaries);
+        } else {
+            vk::RenderingInfo rendering_info = recording.rendering.info;
+            rendering_info.flags |= vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+            cmd.beginRendering(rendering_info);
+            cmd.executeCommands(pass_secondaries);
+            cmd.endRendering();
+        }
     }
+    resource_states_->use(framebuffer_->image, ResourceUsage::Present);
+    resource_states_->flush(cmd);
     std::ignore = cmd.end();
 
     {
@@ -241,11 +406,11 @@ Sink* RenderGraph::find_sink(SinkRef ref) const {
         return sink_entry->second.get();
     }
 
-    auto pass_entry = passes_.find(ref.pass);
-    if (pass_entry == passes_.end()) {
+    auto pass_entry = pass_indices_.find(ref.pass);
+    if (pass_entry == pass_indices_.end()) {
         log_error("pass {} does not exist", ref.pass.to_string());
         return nullptr;
     }
-    return pass_entry->second->find_sink(ref.sink);
+    return passes_[pass_entry->second]->find_sink(ref.sink);
 }
 } // namespace vee::rdg
\ No newline at end of file
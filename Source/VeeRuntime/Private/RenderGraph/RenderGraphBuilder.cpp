@@ -15,10 +15,159 @@
 
 #include "RenderGraph/RenderGraphBuilder.hpp"
 
+#include "Logging.hpp"
+#include "RenderGraph/Source.hpp"
+
+#include <algorithm>
+#include <limits>
+
 namespace vee::rdg {
+namespace {
+/**
+ * Whether a Pass using a transient image this way writes it, and so has to run before the Passes
+ * that only read it.
+ */
+bool writes_transient(ResourceUsage usage) {
+    return usage == ResourceUsage::TransferDst || usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::Storage;
+}
+} // namespace
+
 RenderGraphBuilder::~RenderGraphBuilder() = default;
 
+void RenderGraphBuilder::add_transient_image(SinkHandle name, TransientImageDesc desc) {
+    VASSERT(
+        std::ranges::find(transient_images_, name, &std::pair<SinkHandle, TransientImageDesc>::first) == transient_images_.end(),
+        "Attempted to add two transient images with the same name"
+    );
+    transient_images_.emplace_back(name, desc);
+}
+
 RenderGraph RenderGraphBuilder::build(RenderCtx& render_ctx) {
-    return {std::move(passes_), std::move(pass_order_), render_ctx};
+    RenderGraphSchedule schedule = schedule_passes();
+
+    // The RenderGraph walks its Passes in schedule order every frame, so store them that way
+    std::vector<std::unique_ptr<Pass>> passes;
+    passes.reserve(schedule.pass_order.size());
+    for (const PassHandle& pass_handle : schedule.pass_order) {
+        passes.push_back(std::move(passes_.at(pass_handle)));
+    }
+    passes_.clear();
+    return {std::move(passes), std::move(schedule), transient_images_, render_ctx};
+}
+
+RenderGraphSchedule RenderGraphBuilder::schedule_passes() const {
+    // Passes are referred to by the order they were added in while sorting, which is also the order
+    // independent Passes keep
+    std::unordered_map<PassHandle, std::size_t> pass_indices;
+    for (std::size_t i = 0; i < pass_order_.size(); ++i) {
+        pass_indices.insert({pass_order_[i], i});
+    }
+
+    std::vector<std::vector<std::size_t>> dependents(pass_order_.size());
+    std::vector<std::size_t> num_dependencies(pass_order_.size(), 0);
+
+    // Passes sharing a transient image through its global Sink aren't linked to each other, so
+    // order them here instead: the one Pass that writes the image runs before every Pass reading it
+    constexpr std::size_t NO_WRITER = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> transient_writers(transient_images_.size(), NO_WRITER);
+    std::vector<std::vector<std::size_t>> transient_readers(transient_images_.size());
+
+    for (std::size_t i = 0; i < pass_order_.size(); ++i) {
+        const PassHandle pass_handle = pass_order_[i];
+        for (const auto& source : passes_.at(pass_handle)->iterate_sources()) {
+            const SinkRef& ref = source->sink_ref;
+            VASSERT(ref.sink != SinkHandle(), "Pass {} has a source that is not linked to any sink", pass_handle.to_string());
+            if (ref.pass == GLOBAL) {
+                // Global sinks belong to the RenderGraph and are checked when it resolves them
+                const auto transient = std::ranges::find(transient_images_, ref.sink, &std::pair<SinkHandle, TransientImageDesc>::first);
+                if (transient == transient_images_.end()) {
+                    continue;
+                }
+                const auto transient_index = static_cast<std::size_t>(transient - transient_images_.begin());
+                if (!writes_transient(source->usage)) {
+                    transient_readers[transient_index].push_back(i);
+                    continue;
+                }
+                std::size_t& writer = transient_writers[transient_index];
+                VASSERT(
+                    writer == NO_WRITER || writer == i,
+                    "Passes {} and {} both write transient image {} through its global sink, link the later one to the earlier one's sink instead",
+                    pass_order_[writer == NO_WRITER ? i : writer].to_string(),
+                    pass_handle.to_string(),
+                    ref.sink.to_string()
+                );
+                if (writer == NO_WRITER) {
+                    writer = i;
+                }
+                continue;
+            }
+
+            const auto dependency = pass_indices.find(ref.pass);
+            VASSERT(dependency != pass_indices.end(), "Pass {} links to a sink of pass {}, which was never added", pass_handle.to_string(), ref.pass.to_string());
+            if (dependency == pass_indices.end()) {
+                continue;
+            }
+            VASSERT(passes_.at(ref.pass)->find_sink(ref.sink) != nullptr, "Pass {} links to missing sink {} of pass {}", pass_handle.to_string(), ref.sink.to_string(), ref.pass.to_string());
+
+            dependents[dependency->second].push_back(i);
+            ++num_dependencies[i];
+        }
+    }
+    for (std::size_t t = 0; t < transient_images_.size(); ++t) {
+        const std::size_t writer = transient_writers[t];
+        if (writer == NO_WRITER) {
+            continue;
+        }
+        for (const std::size_t reader : transient_readers[t]) {
+            if (reader != writer) {
+                dependents[writer].push_back(reader);
+                ++num_dependencies[reader];
+            }
+        }
+    }
+
+    // Kahn's algorithm, one level at a time. A level holds every Pass whose dependencies were all
+    // scheduled by the previous levels.
+    RenderGraphSchedule schedule;
+    schedule.pass_order.reserve(pass_order_.size());
+    schedule.level_offsets.clear();
+    std::vector<std::size_t> level;
+    std::vector<std::size_t> next_level;
+    for (std::size_t i = 0; i < pass_order_.size(); ++i) {
+        if (num_dependencies[i] == 0) {
+            level.push_back(i);
+        }
+    }
+    while (!level.empty()) {
+        std::ranges::sort(level);
+        schedule.level_offsets.push_back(schedule.pass_order.size());
+        next_level.clear();
+        for (const std::size_t pass_index : level) {
+            schedule.pass_order.push_back(pass_order_[pass_index]);
+            for (const std::size_t dependent : dependents[pass_index]) {
+                if (--num_dependencies[dependent] == 0) {
+                    next_level.push_back(dependent);
+                }
+            }
+        }
+        std::swap(level, next_level);
+    }
+
+    if (schedule.pass_order.size() != pass_order_.size()) {
+        // Passes that were never scheduled are part of a cycle or depend on one. Report them, then
+        // fall back to running them in the order they were added in.
+        schedule.level_offsets.push_back(schedule.pass_order.size());
+        for (std::size_t i = 0; i < pass_order_.size(); ++i) {
+            if (num_dependencies[i] != 0) {
+                log_error("RenderGraph pass {} is part of or depends on a dependency cycle", pass_order_[i].to_string());
+                schedule.pass_order.push_back(pass_order_[i]);
+            }
+        }
+        VASSERT(false, "RenderGraph passes are linked in a cycle");
+    }
+    schedule.level_offsets.push_back(schedule.pass_order.size());
+
+    log_trace("RenderGraph scheduled {} passes in {} levels", schedule.pass_order.size(), schedule.num_levels());
+    return schedule;
 }
 } // namespace vee::rdg
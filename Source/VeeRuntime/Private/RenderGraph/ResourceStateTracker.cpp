@@ -0,0 +1,192 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "RenderGraph/ResourceStateTracker.hpp"
+
+#include "Assert.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace vee::rdg {
+namespace {
+struct UsageInfo {
+    vk::PipelineStageFlags2 stages;
+    vk::AccessFlags2 access;
+    vk::ImageLayout layout;
+    bool writes;
+};
+
+constexpr vk::AccessFlags2 WRITE_ACCESS =
+    vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderStorageWrite;
+
+UsageInfo usage_info(ResourceUsage usage) {
+    switch (usage) {
+    case ResourceUsage::ColorAttachment:
+        return {
+            vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+            vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            true
+        };
+    case ResourceUsage::TransferSrc:
+        return {vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal, false};
+    case ResourceUsage::TransferDst:
+        return {vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal, true};
+    case ResourceUsage::Sampled:
+        return {
+            vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+            vk::AccessFlagBits2::eShaderSampledRead,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            false
+        };
+    case ResourceUsage::Storage:
+        return {
+            vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+            vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+            vk::ImageLayout::eGeneral,
+            true
+        };
+    case ResourceUsage::Present:
+        // The submit's signal semaphore orders presentation after the transition
+        return {vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone, vk::ImageLayout::ePresentSrcKHR, false};
+    case ResourceUsage::None:
+        break;
+    }
+    VASSERT(false, "ResourceUsage::None has no access");
+    return {};
+}
+} // namespace
+
+void ResourceStateTracker::reset() {
+    images_.clear();
+    buffers_.clear();
+}
+
+void ResourceStateTracker::set_initial_stages(vk::Image image, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access) {
+    AccessState& state = find_or_add(images_, image).state;
+    state.write_stages = stages;
+    state.write_access = access;
+}
+
+void ResourceStateTracker::use(vk::Image image, ResourceUsage usage) {
+    if (usage == ResourceUsage::None) {
+        return;
+    }
+    TrackedResource<vk::Image>& resource = find_or_add(images_, image);
+    add_use(resource.pending, resource.has_pending, usage);
+}
+
+void ResourceStateTracker::use(vk::Buffer buffer, ResourceUsage usage) {
+    if (usage == ResourceUsage::None) {
+        return;
+    }
+    VASSERT(usage != ResourceUsage::ColorAttachment && usage != ResourceUsage::Present, "Buffers can't be used as attachments or presented");
+    TrackedResource<vk::Buffer>& resource = find_or_add(buffers_, buffer);
+    add_use(resource.pending, resource.has_pending, usage);
+}
+
+void ResourceStateTracker::flush(vk::CommandBuffer cmd) {
+    vk::PipelineStageFlags2 src_stages;
+    vk::AccessFlags2 src_access;
+    for (TrackedResource<vk::Image>& image : images_) {
+        if (!std::exchange(image.has_pending, false)) {
+            continue;
+        }
+        const vk::ImageLayout old_layout = image.state.layout;
+        if (resolve(image.state, image.pending, true, src_stages, src_access)) {
+            image_barriers_.push_back(
+                {src_stages,
+                 src_access,
+                 image.pending.stages,
+                 image.pending.access,
+                 old_layout,
+                 image.pending.layout,
+                 vk::QueueFamilyIgnored,
+                 vk::QueueFamilyIgnored,
+                 image.handle,
+                 {vk::ImageAspectFlagBits::eColor, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers}}
+            );
+        }
+    }
+    for (TrackedResource<vk::Buffer>& buffer : buffers_) {
+        if (!std::exchange(buffer.has_pending, false)) {
+            continue;
+        }
+        if (resolve(buffer.state, buffer.pending, false, src_stages, src_access)) {
+            buffer_barriers_.push_back(
+                {src_stages, src_access, buffer.pending.stages, buffer.pending.access, vk::QueueFamilyIgnored, vk::QueueFamilyIgnored, buffer.handle, 0, vk::WholeSize}
+            );
+        }
+    }
+
+    if (image_barriers_.empty() && buffer_barriers_.empty()) {
+        return;
+    }
+    vk::DependencyInfo dependency_info;
+    dependency_info.setImageMemoryBarriers(image_barriers_);
+    dependency_info.setBufferMemoryBarriers(buffer_barriers_);
+    cmd.pipelineBarrier2(dependency_info);
+    image_barriers_.clear();
+    buffer_barriers_.clear();
+}
+
+template <typename Handle>
+ResourceStateTracker::TrackedResource<Handle>& ResourceStateTracker::find_or_add(std::vector<TrackedResource<Handle>>& resources, Handle handle) {
+    const auto resource = std::ranges::find(resources, handle, &TrackedResource<Handle>::handle);
+    if (resource != resources.end()) {
+        return *resource;
+    }
+    return resources.emplace_back(handle);
+}
+
+void ResourceStateTracker::add_use(PendingUse& pending, bool& has_pending, ResourceUsage usage) {
+    const UsageInfo info = usage_info(usage);
+    if (!has_pending) {
+        pending = {info.stages, info.access, info.layout, info.writes};
+        has_pending = true;
+        return;
+    }
+    // Several uses of one resource by the same Pass are synchronized as one
+    VASSERT(pending.layout == info.layout, "A Pass uses an image in two different layouts");
+    pending.stages |= info.stages;
+    pending.access |= info.access;
+    pending.writes |= info.writes;
+}
+
+bool ResourceStateTracker::resolve(AccessState& state, const PendingUse& use, bool is_image, vk::PipelineStageFlags2& src_stages, vk::AccessFlags2& src_access) {
+    const bool transition = is_image && state.layout != use.layout;
+    if (transition || use.writes) {
+        // Layout transitions and writes wait for every earlier access. A layout transition for a
+        // read counts as a write the reading stages can see.
+        src_stages = state.write_stages | state.read_stages;
+        src_access = state.write_access;
+        state.layout = use.layout;
+        state.write_stages = use.stages;
+        state.write_access = use.writes ? use.access & WRITE_ACCESS : vk::AccessFlags2();
+        state.visible_stages = use.writes ? vk::PipelineStageFlags2() : use.stages;
+        state.read_stages = use.writes ? vk::PipelineStageFlags2() : use.stages;
+        return transition || src_stages;
+    }
+
+    // Reads only have to wait for the last write, and only once per stage
+    const bool needs_barrier = state.write_stages && (use.stages & ~state.visible_stages);
+    src_stages = state.write_stages;
+    src_access = state.write_access;
+    state.visible_stages |= use.stages;
+    state.read_stages |= use.stages;
+    return needs_barrier;
+}
+} // namespace vee::rdg
@@ -0,0 +1,103 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include "RenderGraph/ResourceUsage.hpp"
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace vee::rdg {
+
+/**
+ * Tracks the layout and pending accesses of every image and buffer a RenderGraph synchronizes
+ * during a frame, and turns the uses declared by a Pass into the barriers needed before it
+ * executes.
+ *
+ * Uses are collected with use() and resolved together by flush(), which records all the barriers a
+ * Pass needs as one pipelineBarrier2. Uses of the same resource within one flush are merged.
+ * Reads in the same layout by stages the last write was already made visible to need no barrier
+ * at all.
+ */
+class ResourceStateTracker {
+public:
+    /**
+     * Forget every resource, at the start of a frame. Resources start out in an undefined layout
+     * with nothing to wait for.
+     */
+    void reset();
+
+    /**
+     * Make the first barrier of an image wait for stages, such as the stage a swapchain acquire
+     * semaphore is waited on, and make access available.
+     */
+    void set_initial_stages(vk::Image image, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access = {});
+
+    void use(vk::Image image, ResourceUsage usage);
+    void use(vk::Buffer buffer, ResourceUsage usage);
+
+    /**
+     * Record the barriers for every use since the last flush.
+     */
+    void flush(vk::CommandBuffer cmd);
+
+private:
+    struct AccessState {
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        // Stages and accesses of the last write or layout transition
+        vk::PipelineStageFlags2 write_stages = vk::PipelineStageFlagBits2::eNone;
+        vk::AccessFlags2 write_access = vk::AccessFlagBits2::eNone;
+        // Stages the last write is visible to
+        vk::PipelineStageFlags2 visible_stages = vk::PipelineStageFlagBits2::eNone;
+        // Stages that read since the last write
+        vk::PipelineStageFlags2 read_stages = vk::PipelineStageFlagBits2::eNone;
+    };
+
+    struct PendingUse {
+        vk::PipelineStageFlags2 stages = vk::PipelineStageFlagBits2::eNone;
+        vk::AccessFlags2 access = vk::AccessFlagBits2::eNone;
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        bool writes = false;
+    };
+
+    template <typename Handle>
+    struct TrackedResource {
+        Handle handle;
+        AccessState state;
+        PendingUse pending;
+        bool has_pending = false;
+    };
+
+    template <typename Handle>
+    static TrackedResource<Handle>& find_or_add(std::vector<TrackedResource<Handle>>& resources, Handle handle);
+
+    static void add_use(PendingUse& pending, bool& has_pending, ResourceUsage usage);
+
+    /**
+     * Advance state past a use.
+     * @return True if the use needs a barrier. src_stages and src_access are set to what it waits
+     * for.
+     */
+    static bool resolve(AccessState& state, const PendingUse& use, bool is_image, vk::PipelineStageFlags2& src_stages, vk::AccessFlags2& src_access);
+
+    // A frame only touches a handful of resources, linear searches beat hashing here
+    std::vector<TrackedResource<vk::Image>> images_;
+    std::vector<TrackedResource<vk::Buffer>> buffers_;
+
+    std::vector<vk::ImageMemoryBarrier2> image_barriers_;
+    std::vector<vk::BufferMemoryBarrier2> buffer_barriers_;
+};
+} // namespace vee::rdg
@@ -0,0 +1,60 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "RenderGraph/SecondaryCommandPools.hpp"
+
+#include "Assert.hpp"
+#include "JobManager.hpp"
+#include "Renderer/RenderCtx.hpp"
+
+namespace vee::rdg {
+SecondaryCommandPools::SecondaryCommandPools(RenderCtx& ctx, std::size_t num_frames, std::size_t num_threads)
+    : device_(ctx.device)
+    , num_threads_(num_threads)
+    , pools_(num_frames * num_threads) {
+    // Buffers are re-recorded every frame and only ever reset along with their pool
+    const vk::CommandPoolCreateInfo pool_info(vk::CommandPoolCreateFlagBits::eTransient, ctx.graphics_queue_family);
+    for (ThreadPool& pool : pools_) {
+        pool.pool = device_.createCommandPool(pool_info).value;
+    }
+}
+
+SecondaryCommandPools::~SecondaryCommandPools() {
+    for (const ThreadPool& pool : pools_) {
+        device_.destroyCommandPool(pool.pool);
+    }
+}
+
+void SecondaryCommandPools::begin_frame(std::size_t frame) {
+    current_frame_ = frame;
+    for (std::size_t thread = 0; thread < num_threads_; ++thread) {
+        ThreadPool& pool = pools_[frame * num_threads_ + thread];
+        std::ignore = device_.resetCommandPool(pool.pool);
+        pool.num_used = 0;
+    }
+}
+
+vk::CommandBuffer SecondaryCommandPools::allocate() {
+    const std::size_t thread = JobManager::current_worker_index();
+    VASSERT(thread < num_threads_, "Thread {} has no secondary command pool", thread);
+
+    ThreadPool& pool = pools_[current_frame_ * num_threads_ + thread];
+    if (pool.num_used == pool.buffers.size()) {
+        const vk::CommandBufferAllocateInfo buffer_info(pool.pool, vk::CommandBufferLevel::eSecondary, 1);
+        pool.buffers.push_back(device_.allocateCommandBuffers(buffer_info).value.front());
+    }
+    return pool.buffers[pool.num_used++];
+}
+} // namespace vee::rdg
@@ -0,0 +1,70 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace vee {
+class RenderCtx;
+}
+
+namespace vee::rdg {
+/**
+ * Command pools for recording secondary command buffers on JobManager workers. Every thread gets
+ * its own pool per frame in flight, so recording never takes a lock, and a frame's buffers are
+ * reused by resetting its pools once the frame's fence was waited on.
+ */
+class SecondaryCommandPools {
+public:
+    /**
+     * @param num_threads Number of threads that allocate buffers, JobManager::num_workers() plus
+     * the main thread.
+     */
+    SecondaryCommandPools(RenderCtx& ctx, std::size_t num_frames, std::size_t num_threads);
+    ~SecondaryCommandPools();
+
+    SecondaryCommandPools(const SecondaryCommandPools&) = delete;
+    SecondaryCommandPools& operator=(const SecondaryCommandPools&) = delete;
+
+    /**
+     * Reset the pools of a frame in flight and allocate from them until the next call. Whatever the
+     * frame last submitted must have completed.
+     */
+    void begin_frame(std::size_t frame);
+
+    /**
+     * @return A secondary command buffer from the calling thread's pool, ready to begin. Only call
+     * from the main thread or a JobManager worker.
+     */
+    vk::CommandBuffer allocate();
+
+private:
+    // Padded so that threads handing out buffers don't share cache lines
+    struct alignas(64) ThreadPool {
+        vk::CommandPool pool;
+        std::vector<vk::CommandBuffer> buffers;
+        std::size_t num_used = 0;
+    };
+
+    vk::Device device_;
+    std::size_t num_threads_;
+    // num_threads_ pools per frame in flight
+    std::vector<ThreadPool> pools_;
+    std::size_t current_frame_ = 0;
+};
+} // namespace vee::rdg
@@ -0,0 +1,187 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "RenderGraph/TransientImagePool.hpp"
+
+#include "Assert.hpp"
+#include "Renderer/RenderCtx.hpp"
+#include "RenderGraph/ImageResource.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace vee::rdg {
+namespace {
+vk::DeviceSize align_up(vk::DeviceSize value, vk::DeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool lifetimes_overlap(const AliasRequest& a, const AliasRequest& b) {
+    return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+} // namespace
+
+vk::DeviceSize place_aliased(std::span<const AliasRequest> requests, std::span<vk::DeviceSize> offsets) {
+    VASSERT(offsets.size() == requests.size());
+    std::vector<std::size_t> order(requests.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::ranges::stable_sort(order, std::ranges::greater(), [&](std::size_t i) { return requests[i].size; });
+
+    vk::DeviceSize total_size = 0;
+    std::vector<std::size_t> placed;
+    // Memory ranges taken by placed blocks that are alive at the same time as the current one
+    std::vector<std::pair<vk::DeviceSize, vk::DeviceSize>> taken;
+    for (const std::size_t i : order) {
+        const AliasRequest& request = requests[i];
+        taken.clear();
+        for (const std::size_t other : placed) {
+            if (lifetimes_overlap(request, requests[other])) {
+                taken.emplace_back(offsets[other], offsets[other] + requests[other].size);
+            }
+        }
+        std::ranges::sort(taken);
+
+        vk::DeviceSize offset = 0;
+        for (const auto& [begin, end] : taken) {
+            if (offset + request.size <= begin) {
+                break;
+            }
+            offset = std::max(offset, align_up(end, request.alignment));
+        }
+        offsets[i] = offset;
+        total_size = std::max(total_size, offset + request.size);
+        placed.push_back(i);
+    }
+    return total_size;
+}
+
+TransientImagePool::TransientImagePool(RenderCtx& ctx, std::vector<Image>&& images, std::size_t num_frames)
+    : device_(ctx.device)
+    , allocator_(ctx.allocator)
+    , images_(std::move(images))
+    , frames_(num_frames) {
+    if (images_.empty()) {
+        return;
+    }
+
+    for (Frame& frame : frames_) {
+        for (const Image& image : images_) {
+            const vk::ImageCreateInfo image_info = {
+                {},
+                vk::ImageType::e2D,
+                image.desc.format,
+                {image.desc.width, image.desc.height, 1},
+                1,
+                1,
+                vk::SampleCountFlagBits::e1,
+                vk::ImageTiling::eOptimal,
+                image.usage
+            };
+            frame.images.push_back(device_.createImage(image_info).value);
+        }
+    }
+
+    // Every frame creates the same images, so they all share the placement of the first frame
+    std::vector<AliasRequest> requests;
+    vk::DeviceSize alignment = 1;
+    uint32_t memory_type_bits = UINT32_MAX;
+    for (std::size_t i = 0; i < images_.size(); ++i) {
+        const vk::MemoryRequirements requirements = device_.getImageMemoryRequirements(frames_.front().images[i]);
+        requests.push_back({requirements.size, requirements.alignment, images_[i].first_use, images_[i].last_use});
+        alignment = std::max(alignment, requirements.alignment);
+        memory_type_bits &= requirements.memoryTypeBits;
+        stats_.unaliased_bytes += requirements.size;
+    }
+    VASSERT(memory_type_bits != 0, "Transient images have no memory type in common");
+
+    std::vector<vk::DeviceSize> offsets(requests.size());
+    const vk::DeviceSize heap_size = place_aliased(requests, offsets);
+    stats_.aliased_bytes = heap_size;
+
+    std::vector<std::size_t> aliased_indices;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        for (std::size_t other = 0; other < requests.size(); ++other) {
+            const bool used_before = requests[other].last_use < requests[i].first_use;
+            const bool shares_memory = offsets[other] < offsets[i] + requests[i].size && offsets[i] < offsets[other] + requests[other].size;
+            if (used_before && shares_memory) {
+                aliased_indices.push_back(i);
+                break;
+            }
+        }
+    }
+
+    const vk::MemoryRequirements heap_requirements = {heap_size, alignment, memory_type_bits};
+    constexpr vma::AllocationCreateInfo allocation_info = {{}, vma::MemoryUsage::eGpuOnly, {}, vk::MemoryPropertyFlagBits::eDeviceLocal};
+    for (Frame& frame : frames_) {
+        frame.allocation = allocator_.allocateMemory(heap_requirements, allocation_info).value;
+        for (std::size_t i = 0; i < images_.size(); ++i) {
+            std::ignore = allocator_.bindImageMemory2(frame.allocation, offsets[i], frame.images[i], nullptr);
+            const vk::ImageViewCreateInfo view_info = {
+                {}, frame.images[i], vk::ImageViewType::e2D, images_[i].desc.format, {}, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+            };
+            frame.views.push_back(device_.createImageView(view_info).value);
+        }
+        for (const std::size_t i : aliased_indices) {
+            frame.aliased_images.push_back(frame.images[i]);
+        }
+    }
+}
+
+TransientImagePool::~TransientImagePool() {
+    for (Frame& frame : frames_) {
+        for (const vk::ImageView view : frame.views) {
+            device_.destroyImageView(view);
+        }
+        for (const vk::Image image : frame.images) {
+            device_.destroyImage(image);
+        }
+        if (frame.allocation) {
+            allocator_.freeMemory(frame.allocation);
+        }
+    }
+}
+
+void TransientImagePool::select_frame(std::size_t frame) {
+    current_frame_ = frame;
+    for (std::size_t i = 0; i < images_.size(); ++i) {
+        ImageResource& resource = *images_[i].resource;
+        resource.image = frames_[frame].images[i];
+        resource.view = frames_[frame].views[i];
+        resource.width = images_[i].desc.width;
+        resource.height = images_[i].desc.height;
+        resource.format = images_[i].desc.format;
+    }
+}
+
+vk::ImageUsageFlags TransientImagePool::usage_flags(ResourceUsage usage) {
+    switch (usage) {
+    case ResourceUsage::ColorAttachment:
+        return vk::ImageUsageFlagBits::eColorAttachment;
+    case ResourceUsage::TransferSrc:
+        return vk::ImageUsageFlagBits::eTransferSrc;
+    case ResourceUsage::TransferDst:
+        return vk::ImageUsageFlagBits::eTransferDst;
+    case ResourceUsage::Sampled:
+        return vk::ImageUsageFlagBits::eSampled;
+    case ResourceUsage::Storage:
+        return vk::ImageUsageFlagBits::eStorage;
+    case ResourceUsage::None:
+    case ResourceUsage::Present:
+        break;
+    }
+    return {};
+}
+} // namespace vee::rdg
@@ -0,0 +1,112 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include "RenderGraph/RenderGraph.hpp"
+#include "RenderGraph/ResourceUsage.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include <vk_mem_alloc.hpp>
+#include <vulkan/vulkan.hpp>
+
+namespace vee {
+class RenderCtx;
+}
+
+namespace vee::rdg {
+class ImageResource;
+
+/**
+ * A block of memory needed from the first to the last of a range of Passes, in schedule order.
+ */
+struct AliasRequest {
+    vk::DeviceSize size;
+    vk::DeviceSize alignment;
+    std::size_t first_use;
+    std::size_t last_use;
+};
+
+/**
+ * Place blocks in one allocation so that blocks whose lifetimes overlap never overlap in memory.
+ * Larger blocks are placed first, each at the lowest offset that fits.
+ * @param requests Blocks to place. Alignments must be powers of two.
+ * @param offsets Receives the offset of each block.
+ * @return Size of the allocation.
+ */
+vk::DeviceSize place_aliased(std::span<const AliasRequest> requests, std::span<vk::DeviceSize> offsets);
+
+/**
+ * Creates the transient images of a RenderGraph in one allocation per frame in flight, placed with
+ * place_aliased.
+ */
+class TransientImagePool {
+public:
+    struct Image {
+        std::shared_ptr<ImageResource> resource;
+        TransientImageDesc desc;
+        vk::ImageUsageFlags usage;
+        std::size_t first_use;
+        std::size_t last_use;
+    };
+
+    TransientImagePool(RenderCtx& ctx, std::vector<Image>&& images, std::size_t num_frames);
+    ~TransientImagePool();
+
+    TransientImagePool(const TransientImagePool&) = delete;
+    TransientImagePool& operator=(const TransientImagePool&) = delete;
+
+    /**
+     * Point every transient ImageResource at the images of a frame in flight. Whatever the frame
+     * last submitted must have completed.
+     */
+    void select_frame(std::size_t frame);
+
+    /**
+     * @return Images of the selected frame that reuse the memory of an image used earlier in the
+     * frame. Their first use has to wait for every earlier use of that memory.
+     */
+    [[nodiscard]] std::span<const vk::Image> aliased_images() const {
+        return frames_[current_frame_].aliased_images;
+    }
+
+    [[nodiscard]] TransientMemoryStats stats() const {
+        return stats_;
+    }
+
+    /**
+     * @return The image usage flags a use requires.
+     */
+    static vk::ImageUsageFlags usage_flags(ResourceUsage usage);
+
+private:
+    struct Frame {
+        vma::Allocation allocation;
+        std::vector<vk::Image> images;
+        std::vector<vk::ImageView> views;
+        std::vector<vk::Image> aliased_images;
+    };
+
+    vk::Device device_;
+    vma::Allocator allocator_;
+    std::vector<Image> images_;
+    std::vector<Frame> frames_;
+    std::size_t current_frame_ = 0;
+    TransientMemoryStats stats_;
+};
+} // namespace vee::rdg
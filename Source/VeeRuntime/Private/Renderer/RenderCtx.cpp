@@ -123,10 +123,8 @@ RenderCtx::RenderCtx(const platform::Window& window)
 
 
     // Command pool
-    const vk::CommandPoolCreateInfo cpci(
-        vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-        vkb_device.get_queue_index(vkb::QueueType::graphics).value()
-    );
+    graphics_queue_family = vkb_device.get_queue_index(vkb::QueueType::graphics).value();
+    const vk::CommandPoolCreateInfo cpci(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, graphics_queue_family);
 
     command_pool = vk::Device(device).createCommandPool(cpci).value;
 
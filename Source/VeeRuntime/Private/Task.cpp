@@ -0,0 +1,167 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include "Task.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace vee {
+// Frames are rounded up to a multiple of this, larger frames go straight to operator new
+constexpr static std::size_t FRAME_SIZE_GRANULARITY = 64;
+constexpr static std::size_t NUM_FRAME_SIZE_CLASSES = 32;
+constexpr static std::size_t LOCAL_FRAME_CACHE_SIZE = 32;
+
+static const Name TASK_JOB_NAME = "task"_hash;
+
+// Set while a task job runs. Tasks run as leaf jobs, so the task stays on this thread until it
+// suspends.
+thread_local static detail::ResumeContext current_context;
+
+/**
+ * Free frames of one size class shared by all threads.
+ */
+struct SharedFramePool {
+    std::mutex mutex;
+    std::vector<void*> free;
+
+    ~SharedFramePool() {
+        for (void* frame : free) {
+            ::operator delete(frame);
+        }
+    }
+};
+
+static std::array<SharedFramePool, NUM_FRAME_SIZE_CLASSES> shared_frames;
+
+/**
+ * Frames are usually freed on a different thread than they were allocated on, so each thread keeps
+ * a small cache per size class that is refilled from and spilled to the shared pools in batches.
+ */
+struct LocalFrameCache {
+    std::array<std::vector<void*>, NUM_FRAME_SIZE_CLASSES> free;
+
+    ~LocalFrameCache() {
+        for (std::size_t size_class = 0; size_class < NUM_FRAME_SIZE_CLASSES; ++size_class) {
+            std::lock_guard lock(shared_frames[size_class].mutex);
+            shared_frames[size_class].free.insert(shared_frames[size_class].free.end(), free[size_class].begin(), free[size_class].end());
+        }
+    }
+};
+
+thread_local static LocalFrameCache local_frames;
+
+static std::size_t frame_size_class(std::size_t size) {
+    return (size + FRAME_SIZE_GRANULARITY - 1) / FRAME_SIZE_GRANULARITY - 1;
+}
+
+void* detail::allocate_task_frame(std::size_t size) {
+    const std::size_t size_class = frame_size_class(size);
+    if (size_class >= NUM_FRAME_SIZE_CLASSES) {
+        return ::operator new(size);
+    }
+
+    std::vector<void*>& cache = local_frames.free[size_class];
+    if (cache.empty()) {
+        SharedFramePool& pool = shared_frames[size_class];
+        std::lock_guard lock(pool.mutex);
+        const std::size_t count = std::min(pool.free.size(), LOCAL_FRAME_CACHE_SIZE / 2);
+        cache.insert(cache.end(), pool.free.end() - static_cast<std::ptrdiff_t>(count), pool.free.end());
+        pool.free.resize(pool.free.size() - count);
+    }
+    if (cache.empty()) {
+        return ::operator new((size_class + 1) * FRAME_SIZE_GRANULARITY);
+    }
+    void* frame = cache.back();
+    cache.pop_back();
+    return frame;
+}
+
+void detail::free_task_frame(void* frame, std::size_t size) noexcept {
+    const std::size_t size_class = frame_size_class(size);
+    if (size_class >= NUM_FRAME_SIZE_CLASSES) {
+        ::operator delete(frame);
+        return;
+    }
+
+    std::vector<void*>& cache = local_frames.free[size_class];
+    cache.push_back(frame);
+    if (cache.size() > LOCAL_FRAME_CACHE_SIZE) {
+        SharedFramePool& pool = shared_frames[size_class];
+        const auto spilled = cache.end() - static_cast<std::ptrdiff_t>(LOCAL_FRAME_CACHE_SIZE / 2);
+        std::lock_guard lock(pool.mutex);
+        pool.free.insert(pool.free.end(), spilled, cache.end());
+        cache.erase(spilled, cache.end());
+    }
+}
+
+void detail::schedule_resume(std::coroutine_handle<> handle, JobCounter* wait_counter, JobPriority priority, bool main_thread_only) {
+    JobManager::queue_job(
+        {
+            .name = TASK_JOB_NAME,
+            .entry = [handle, priority, main_thread_only] {
+                const detail::ResumeContext outer = std::exchange(current_context, {priority, main_thread_only});
+                handle.resume();
+                current_context = outer;
+            },
+            .priority = priority,
+            .main_thread_only = main_thread_only,
+            .leaf = true,
+        },
+        wait_counter
+    );
+}
+
+detail::ResumeContext detail::current_resume_context() {
+    return current_context;
+}
+
+namespace {
+/**
+ * Owns a spawned task. Its frame destroys itself once the task finished, taking the task with it.
+ */
+struct DetachedTask {
+    struct promise_type : detail::TaskPromiseBase {
+        DetachedTask get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+DetachedTask run_detached(Task<void> task, JobCounter* signal_counter) {
+    co_await task;
+    if (signal_counter != nullptr) {
+        JobManager::detail::signal_counter(*signal_counter);
+    }
+}
+} // namespace
+
+void spawn(Task<void> task, JobCounter* signal_counter, JobPriority priority) {
+    if (signal_counter != nullptr) {
+        JobManager::detail::add_to_counter(*signal_counter, 1);
+    }
+    detail::schedule_resume(run_detached(std::move(task), signal_counter).handle, nullptr, priority, false);
+}
+} // namespace vee
@@ -0,0 +1,184 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace vee {
+
+template <typename T>
+concept TimerNode = requires(T& timer) {
+    { timer.deadline } -> std::same_as<uint64_t&>;
+    { timer.next } -> std::same_as<T*&>;
+};
+
+/**
+ * Hierarchical timer wheel in the style of "Hashed and Hierarchical Timing Wheels" (Varghese and
+ * Lauck, 1987). Timers are intrusive singly linked nodes with an absolute deadline in ticks.
+ *
+ * Level 0 has one slot per tick, every level above covers a whole rotation of the one below per
+ * slot. Timers sit in the lowest level whose current rotation contains their deadline, and are
+ * moved down a level when time reaches their slot. Inserting and expiring are O(1), advancing is
+ * proportional to the number of occupied slots passed rather than the number of ticks.
+ *
+ * Not thread-safe.
+ */
+template <TimerNode T>
+class TimerWheel {
+public:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t NUM_SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t NUM_LEVELS = 4;
+    /**
+     * Longest delay the wheel can represent. Timers further out wait at the end of the wheel and
+     * are put back in until their deadline is within reach, so they never expire early.
+     */
+    static constexpr uint64_t MAX_DELAY = (uint64_t{1} << (SLOT_BITS * NUM_LEVELS)) - 1;
+    static constexpr uint64_t NO_DEADLINE = std::numeric_limits<uint64_t>::max();
+
+    [[nodiscard]] uint64_t now() const {
+        return now_;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size_ == 0;
+    }
+
+    /**
+     * Add a timer. Deadlines that already passed expire on the next tick.
+     */
+    void insert(T* timer) {
+        timer->deadline = std::max(timer->deadline, now_ + 1);
+        place(timer);
+        ++size_;
+    }
+
+    /**
+     * Move time forward to now, calling on_expired for every timer whose deadline passed, in
+     * deadline order. on_expired may insert new timers.
+     */
+    template <typename Fn>
+    void advance(uint64_t now, Fn&& on_expired) {
+        while (now_ < now) {
+            const uint64_t next = next_event();
+            if (next > now) {
+                now_ = now;
+                break;
+            }
+            now_ = next;
+
+            // Cascade top down so that timers moved out of a higher level that land in a slot
+            // that is due right now are moved down again.
+            for (uint32_t level = NUM_LEVELS - 1; level > 0; --level) {
+                if ((now_ & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0) {
+                    for (T* timer = take_slot(level, slot_index(now_, level)); timer != nullptr;) {
+                        T* next_timer = std::exchange(timer->next, nullptr);
+                        place(timer);
+                        timer = next_timer;
+                    }
+                }
+            }
+
+            for (T* timer = take_slot(0, slot_index(now_, 0)); timer != nullptr;) {
+                T* next_timer = std::exchange(timer->next, nullptr);
+                if (timer->deadline > now_) {
+                    // Reached the end of the wheel before its deadline
+                    place(timer);
+                } else {
+                    --size_;
+                    on_expired(timer);
+                }
+                timer = next_timer;
+            }
+        }
+    }
+
+    /**
+     * @return The next tick at which a timer may expire, or NO_DEADLINE if the wheel is empty. This
+     * can be earlier than any actual deadline when timers still have to move down a level first.
+     */
+    [[nodiscard]] uint64_t next_event() const {
+        for (uint32_t level = 0; level < NUM_LEVELS; ++level) {
+            const uint32_t shift = SLOT_BITS * level;
+            const uint32_t current = slot_index(now_, level);
+            // Slots after the current one in this rotation. Below the top level, timers are never
+            // in the current slot or before it.
+            uint64_t pending = occupied_[level] & ~((uint64_t{2} << current) - 1);
+            uint64_t rotation = now_ >> (shift + SLOT_BITS);
+            if (pending == 0 && level == NUM_LEVELS - 1 && occupied_[level] != 0) {
+                // The top level wraps around to the next rotation
+                pending = occupied_[level];
+                ++rotation;
+            }
+            if (pending != 0) {
+                return (rotation << (shift + SLOT_BITS)) | (static_cast<uint64_t>(std::countr_zero(pending)) << shift);
+            }
+        }
+        return NO_DEADLINE;
+    }
+
+    /**
+     * Remove every timer without expiring it, calling fn on each.
+     */
+    template <typename Fn>
+    void clear(Fn&& fn) {
+        for (uint32_t level = 0; level < NUM_LEVELS; ++level) {
+            for (uint32_t slot = 0; slot < NUM_SLOTS; ++slot) {
+                for (T* timer = take_slot(level, slot); timer != nullptr;) {
+                    T* next_timer = std::exchange(timer->next, nullptr);
+                    fn(timer);
+                    timer = next_timer;
+                }
+            }
+        }
+        size_ = 0;
+    }
+
+private:
+    static uint32_t slot_index(uint64_t time, uint32_t level) {
+        return static_cast<uint32_t>(time >> (SLOT_BITS * level)) & (NUM_SLOTS - 1);
+    }
+
+    void place(T* timer) {
+        const uint64_t deadline = std::min(timer->deadline, now_ + MAX_DELAY);
+        // The lowest level whose current rotation also contains the deadline
+        uint32_t level = 0;
+        while (level < NUM_LEVELS - 1 && (deadline >> (SLOT_BITS * (level + 1))) != (now_ >> (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        const uint32_t slot = slot_index(deadline, level);
+        timer->next = slots_[level][slot];
+        slots_[level][slot] = timer;
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+
+    T* take_slot(uint32_t level, uint32_t slot) {
+        occupied_[level] &= ~(uint64_t{1} << slot);
+        return std::exchange(slots_[level][slot], nullptr);
+    }
+
+    uint64_t now_ = 0;
+    std::size_t size_ = 0;
+    std::array<uint64_t, NUM_LEVELS> occupied_ = {};
+    std::array<std::array<T*, NUM_SLOTS>, NUM_LEVELS> slots_ = {};
+};
+} // namespace vee
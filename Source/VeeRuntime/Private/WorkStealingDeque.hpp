@@ -0,0 +1,145 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace vee {
+
+/**
+ * Fixed-capacity Chase-Lev work-stealing deque.
+ *
+ * The owning thread pushes and pops at the bottom without taking any locks. Any other thread may
+ * steal from the top. Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Lê et al., 2013).
+ * @tparam T Element type. Must be a pointer, nullptr is used to signal an empty deque.
+ * @tparam Capacity Maximum number of elements. Must be a power of two.
+ */
+template <typename T, std::size_t Capacity = 4096>
+    requires std::is_pointer_v<T>
+class WorkStealingDeque {
+    static_assert(std::has_single_bit(Capacity), "WorkStealingDeque capacity must be a power of two");
+
+public:
+    /**
+     * Push an element to the bottom of the deque. May only be called by the owning thread.
+     * @return false if the deque is full. The element was not pushed.
+     */
+    bool push(T element) {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<int64_t>(Capacity)) {
+            return false;
+        }
+
+        slot(bottom).store(element, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Push as many elements as fit to the bottom of the deque, publishing them all at once. May
+     * only be called by the owning thread.
+     * @return The number of elements that were pushed, starting from the front of elements.
+     */
+    std::size_t push_batch(std::span<const T> elements) {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        const std::size_t free_slots = Capacity - static_cast<std::size_t>(bottom - top);
+        const std::size_t count = std::min(free_slots, elements.size());
+
+        for (std::size_t i = 0; i < count; ++i) {
+            slot(bottom + static_cast<int64_t>(i)).store(elements[i], std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + static_cast<int64_t>(count), std::memory_order_relaxed);
+        return count;
+    }
+
+    /**
+     * Pop the most recently pushed element. May only be called by the owning thread.
+     * @return The element, or nullptr if the deque was empty or the last element was stolen.
+     */
+    T pop() {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T element = slot(bottom).load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last element, race any thieves for it.
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                element = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return element;
+    }
+
+    /**
+     * Steal the oldest element. Safe to call from any thread.
+     * @return The element, or nullptr if the deque was empty or another thread won the race.
+     */
+    T steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        T element = slot(top).load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return element;
+    }
+
+    /**
+     * @return Approximate number of elements. Only exact when called by the owning thread while no
+     * other threads are stealing.
+     */
+    [[nodiscard]] std::size_t size_approx() const {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+private:
+    std::atomic<T>& slot(int64_t index) {
+        return buffer_[static_cast<std::size_t>(index) & (Capacity - 1)];
+    }
+
+    // Keep the thief-side and owner-side indices on separate cache lines
+    alignas(64) std::atomic<int64_t> top_ = 0;
+    alignas(64) std::atomic<int64_t> bottom_ = 0;
+    alignas(64) std::array<std::atomic<T>, Capacity> buffer_ = {};
+};
+} // namespace vee
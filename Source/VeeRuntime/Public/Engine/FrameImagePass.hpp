@@ -16,6 +16,7 @@
 #pragma once
 
 #include "Renderer/Buffer.hpp"
+#include "RenderGraph/DirectSink.hpp"
 #include "RenderGraph/Pass.hpp"
 #include "RenderGraph/Sink.hpp"
 
@@ -25,7 +26,6 @@
 
 // TODO: Remove these when removing the temporary sink/source
 #include "MakeSharedEnabler.hpp"
-#include "Renderer/Image.hpp"
 #include "Renderer/RenderCtx.hpp"
 #include "RenderGraph/ImageResource.hpp"
 
@@ -52,32 +52,20 @@ public:
 
     void init(RenderCtx& ctx) override;
     void prepare(const RenderGraph& ctx) override;
+    ResourceRef resource() const override {
+        return {.buffer = &buffer_};
+    }
 
 protected:
     explicit CopyBufferSink(std::shared_ptr<DebugBuffer>& target)
         : Sink()
-        , target(target) {}
-
-    std::array<std::shared_ptr<DebugBuffer>, 3> resources_;
-};
-
-class CopyDestSink : public Sink {
-public:
-    static std::unique_ptr<CopyDestSink> make(std::shared_ptr<ImageResource>& target) {
-        return std::make_unique<MakeSharedEnabler<CopyDestSink>>(target);
+        , target(target) {
+        prepare_every_frame = true;
     }
-    std::shared_ptr<ImageResource>& target;
-
-    void init(RenderCtx& ctx) override;
-    void prepare(const RenderGraph& ctx) override;
-
-
-protected:
-    explicit CopyDestSink(std::shared_ptr<ImageResource>& target)
-        : Sink()
-        , target(target) {}
 
-    std::array<std::unique_ptr<Image>, 3> resource_;
+    std::array<std::shared_ptr<DebugBuffer>, 3> resources_;
+    // The Buffer inside target, for the RenderGraph to synchronize
+    std::shared_ptr<Buffer> buffer_;
 };
 
 class ImageResource;
@@ -85,6 +73,10 @@ class ImageResource;
 // std::array<DebugScreen, 3> debug_screens_;
 class GraphCtx;
 
+/**
+ * Downscales the frame into a small image for Tracy. The small image is a transient image linked
+ * to copy_dest, and is passed on through the copy_dest sink.
+ */
 class FrameImageRenderPass : public Pass {
 public:
     FrameImageRenderPass();
@@ -94,6 +86,19 @@ public:
 protected:
     std::shared_ptr<ImageResource> copy_source_;
     std::shared_ptr<ImageResource> copy_dest_;
+};
+
+/**
+ * Copies the downscaled frame of a FrameImageRenderPass into a host visible buffer.
+ */
+class FrameImageReadbackPass : public Pass {
+public:
+    FrameImageReadbackPass();
+
+    void execute(vk::CommandBuffer cmd) override;
+
+protected:
+    std::shared_ptr<ImageResource> copy_source_;
     std::shared_ptr<DebugBuffer> copy_buffer_;
 };
 
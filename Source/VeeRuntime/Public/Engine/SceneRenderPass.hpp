@@ -17,11 +17,14 @@
 
 #include "RenderGraph/Pass.hpp"
 
-
+#include <cstddef>
+#include <glm/mat4x4.hpp>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
 namespace vee {
 class Buffer;
+class Material;
 }
 namespace vee::rdg {
 class ImageResource;
@@ -30,8 +33,31 @@ public:
     SceneRenderPass();
 
     void execute(vk::CommandBuffer cmd) override;
+    std::size_t prepare_chunks() override;
+    ChunkedRendering chunk_rendering() override;
+    void execute_chunk(vk::CommandBuffer cmd, std::size_t chunk, std::size_t num_chunks) override;
+
+    /**
+     * Sprites recorded by one chunk. Fewer sprites than this are recorded without splitting.
+     */
+    static constexpr std::size_t SPRITES_PER_CHUNK = 256;
 
 protected:
+    struct SpriteDraw {
+        const Material* material;
+        glm::mat4x4 local_to_world;
+    };
+
+    void update_rendering_info();
+    void record_draws(vk::CommandBuffer cmd, std::size_t begin, std::size_t end) const;
+
+    // Gathered on the main thread in prepare_chunks, workers only read them while recording
+    std::vector<SpriteDraw> draws_;
+    glm::mat4x4 view_projection_;
+    vk::Format color_format_;
+    vk::RenderingAttachmentInfo color_attachment_;
+    vk::RenderingInfo rendering_info_;
+
     std::shared_ptr<ImageResource> render_target_;
     std::shared_ptr<Buffer> vertex_buffer_;
     std::shared_ptr<Buffer> index_buffer_;
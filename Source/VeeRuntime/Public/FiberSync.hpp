@@ -0,0 +1,137 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace vee {
+struct Job;
+
+namespace detail {
+    /**
+     * FIFO of suspended jobs, guarded by a spinlock that is only ever held for a few instructions.
+     */
+    class JobWaitList {
+    public:
+        void lock();
+        void unlock();
+
+        /**
+         * Must be called with the list locked.
+         */
+        void push(Job* job);
+        /**
+         * Must be called with the list locked.
+         * @return The job that has waited the longest, or nullptr if the list is empty.
+         */
+        Job* pop();
+
+        /**
+         * Number of waiting jobs. Incremented before a job commits to waiting, so that threads
+         * releasing a resource can skip the lock when nobody is waiting.
+         */
+        std::atomic<uint32_t> num_waiters = 0;
+
+    private:
+        std::atomic<bool> locked_ = false;
+        Job* head_ = nullptr;
+        Job* tail_ = nullptr;
+    };
+} // namespace detail
+
+/**
+ * Mutex for use inside jobs. A contended lock spins briefly, then suspends only the calling job, so
+ * the worker thread goes on to run other jobs instead of blocking. Ownership is handed directly to
+ * the longest waiting job on unlock.
+ *
+ * Outside of a job, lock() spins and yields the thread instead.
+ */
+class FiberMutex {
+public:
+    FiberMutex() = default;
+    FiberMutex(const FiberMutex&) = delete;
+    FiberMutex& operator=(const FiberMutex&) = delete;
+
+    void lock();
+    [[nodiscard]] bool try_lock();
+    void unlock();
+
+private:
+    static bool park(Job* job, void* mutex);
+
+    std::atomic<bool> locked_ = false;
+    detail::JobWaitList waiters_;
+};
+
+/**
+ * Counting semaphore for use inside jobs. Waiting spins briefly, then suspends only the calling
+ * job.
+ */
+class FiberSemaphore {
+public:
+    explicit FiberSemaphore(uint32_t initial_count = 0)
+        : count_(initial_count) {}
+    FiberSemaphore(const FiberSemaphore&) = delete;
+    FiberSemaphore& operator=(const FiberSemaphore&) = delete;
+
+    void acquire();
+    [[nodiscard]] bool try_acquire();
+    void release(uint32_t count = 1);
+
+private:
+    static bool park(Job* job, void* semaphore);
+
+    std::atomic<uint32_t> count_;
+    detail::JobWaitList waiters_;
+};
+
+/**
+ * Condition variable paired with a FiberMutex. Waiting suspends only the calling job.
+ */
+class FiberConditionVariable {
+public:
+    FiberConditionVariable() = default;
+    FiberConditionVariable(const FiberConditionVariable&) = delete;
+    FiberConditionVariable& operator=(const FiberConditionVariable&) = delete;
+
+    /**
+     * Unlock mutex and suspend until notified, then lock mutex again. May wake up spuriously.
+     */
+    void wait(FiberMutex& mutex);
+
+    template <typename Predicate>
+    void wait(FiberMutex& mutex, Predicate predicate) {
+        while (!predicate()) {
+            wait(mutex);
+        }
+    }
+
+    void notify_one();
+    void notify_all();
+
+private:
+    struct ParkContext {
+        FiberConditionVariable* condition;
+        FiberMutex* mutex;
+    };
+
+    static bool park(Job* job, void* context);
+
+    detail::JobWaitList waiters_;
+};
+} // namespace vee
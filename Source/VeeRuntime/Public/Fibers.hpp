@@ -18,16 +18,27 @@
 #include "FiberContext.h"
 #include "Name.hpp"
 
+#include <cstddef>
+#include <cstdint>
 
 namespace vee {
 
+/**
+ * Stack size of fibers created without an explicit one.
+ */
+constexpr std::size_t DEFAULT_FIBER_STACK_SIZE = 512 * 1024;
+
 /**
  * A fiber is a version of a lightweight userspace thread. It is cooperatively scheduled (fibers
  * switch to other fibers) and has its own stack.
  */
 struct Fiber {
     Name name;
+    /**
+     * Lowest address of the fiber's stack. A guard page sits directly below it.
+     */
     void* stack = nullptr;
+    std::size_t stack_size = 0;
     /**
      * Platform/Architecture dependent context. Holds CPU registers for context-switching
      */
@@ -53,13 +64,28 @@ void switch_to_fiber(Fiber& destination);
  * later with switch_to_fiber in order to execute it.
  * @param entry Pointer to the fiber's entry point to begin execution.
  * @param name A name to associate with the fiber. Used by the profiler.
+ * @param stack_size Size of the fiber's stack in bytes. Must be a multiple of the page size.
  */
-Fiber create_fiber(void (*entry)(), Name name);
+Fiber create_fiber(void (*entry)(), Name name, std::size_t stack_size = DEFAULT_FIBER_STACK_SIZE);
 /**
- * Destroy a Fiber. The fiber must not be currently executing.
+ * Destroy a Fiber and release its stack. The fiber must not be currently executing.
  */
 void destroy_fiber(Fiber& fiber);
 
+/**
+ * Fill the unused part of a fiber's stack, everything below its saved stack pointer, with a known
+ * pattern so that fiber_stack_high_water_mark can tell how deep the stack gets. The fiber must not
+ * be running.
+ * @param dirty_bytes Only repaint the top dirty_bytes of the stack, as returned by
+ * fiber_stack_high_water_mark, when the rest of it is known to still hold the pattern.
+ */
+void paint_fiber_stack(Fiber& fiber, std::size_t dirty_bytes = SIZE_MAX);
+/**
+ * @return Bytes at the top of the fiber's stack that were written since it was last painted. The
+ * fiber must not be running.
+ */
+std::size_t fiber_stack_high_water_mark(const Fiber& fiber);
+
 /**
  * Convert the thread that called this function into a fiber.
  * @param fiber Reference to a new empty fiber struct.
@@ -0,0 +1,86 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace vee {
+struct Job;
+
+/**
+ * Tracks the completion of a group of jobs. Jobs that signal a counter increment it when they are
+ * queued and decrement it when they terminate. Jobs waiting on the counter are kept in an intrusive
+ * list on the counter itself, so completing a counter only touches the jobs actually waiting on it.
+ *
+ * Jobs can also wait for the counter to drop to a target value rather than to zero, for example to
+ * start consuming once the first few of a series of batches are done. Signals that can't release
+ * any waiter only take a compare-and-swap.
+ *
+ * A counter must outlive every job that signals or waits on it.
+ */
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    /**
+     * @return The number of jobs that have yet to signal this counter.
+     */
+    [[nodiscard]] uint32_t value() const {
+        return static_cast<uint32_t>(state_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @return True once the counter has reached zero and no other thread is still updating it. The
+     * counter may safely be destroyed afterwards.
+     */
+    [[nodiscard]] bool is_complete() const {
+        return value() == 0 && !locked_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return True once at most target jobs have yet to signal the counter. A target of zero is the
+     * same as is_complete.
+     */
+    [[nodiscard]] bool has_reached(uint32_t target) const {
+        return target == 0 ? is_complete() : value() <= target;
+    }
+
+private:
+    void lock();
+    void unlock();
+
+    // The value in the low half, and the highest target any waiting job waits for in the high half.
+    // Keeping both in one word lets signals check whether they could release a waiter and
+    // decrement in the same compare-and-swap.
+    std::atomic<uint64_t> state_ = 0;
+    std::atomic<bool> locked_ = false;
+    // Intrusive list of jobs waiting for this counter to reach their target. Guarded by locked_.
+    Job* waiters_ = nullptr;
+
+    friend struct Job;
+};
+
+/**
+ * A JobCounter on a cache line of its own, for counters that sit next to each other, such as in an
+ * array, and are signalled from different workers at the same time.
+ */
+class alignas(64) PaddedJobCounter : public JobCounter {};
+
+static_assert(sizeof(PaddedJobCounter) == 64);
+} // namespace vee
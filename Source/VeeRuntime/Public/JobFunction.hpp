@@ -0,0 +1,151 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace vee {
+/**
+ * Type-erased callable stored entirely inline, so that a job's closure lives inside the job record
+ * itself. Unlike std::function it never allocates: a callable whose captures don't fit in
+ * STORAGE_SIZE bytes is a compile error. Capture a pointer to larger data instead.
+ */
+class JobFunction {
+public:
+    constexpr static std::size_t STORAGE_SIZE = 48;
+    constexpr static std::size_t STORAGE_ALIGNMENT = alignof(std::max_align_t);
+
+    JobFunction() = default;
+
+    template <typename Fn>
+        requires(!std::same_as<std::decay_t<Fn>, JobFunction> && std::invocable<std::decay_t<Fn>&>)
+    JobFunction(Fn&& fn) { // NOLINT(*-explicit-constructor)
+        using Callable = std::decay_t<Fn>;
+        static_assert(sizeof(Callable) <= STORAGE_SIZE, "Job captures don't fit in JobFunction::STORAGE_SIZE, capture a pointer to the data instead");
+        static_assert(alignof(Callable) <= STORAGE_ALIGNMENT, "Job captures are over-aligned for JobFunction's storage");
+        static_assert(std::is_copy_constructible_v<Callable>, "Job captures must be copyable");
+
+        ::new (static_cast<void*>(storage_)) Callable(std::forward<Fn>(fn));
+        invoke_ = [](void* storage) {
+            std::invoke(*std::launder(static_cast<Callable*>(storage)));
+        };
+        // Trivial callables (function pointers, lambdas capturing pointers and integers) are copied
+        // with memcpy and need no cleanup.
+        if constexpr (!std::is_trivially_copyable_v<Callable> || !std::is_trivially_destructible_v<Callable>) {
+            manage_ = [](Operation operation, void* dest, void* src) {
+                switch (operation) {
+                case Operation::Copy:
+                    ::new (dest) Callable(*std::launder(static_cast<const Callable*>(src)));
+                    break;
+                case Operation::Move:
+                    ::new (dest) Callable(std::move(*std::launder(static_cast<Callable*>(src))));
+                    std::launder(static_cast<Callable*>(src))->~Callable();
+                    break;
+                case Operation::Destroy:
+                    std::launder(static_cast<Callable*>(dest))->~Callable();
+                    break;
+                }
+            };
+        }
+    }
+
+    JobFunction(const JobFunction& other) {
+        copy_from(other);
+    }
+
+    JobFunction(JobFunction&& other) noexcept {
+        move_from(other);
+    }
+
+    JobFunction& operator=(const JobFunction& other) {
+        if (this != &other) {
+            reset();
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    JobFunction& operator=(JobFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    ~JobFunction() {
+        reset();
+    }
+
+    void operator()() {
+        invoke_(storage_);
+    }
+
+    explicit operator bool() const {
+        return invoke_ != nullptr;
+    }
+
+    /**
+     * Destroy the stored callable, releasing anything it captured.
+     */
+    void reset() {
+        if (manage_ != nullptr) {
+            manage_(Operation::Destroy, storage_, nullptr);
+        }
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+private:
+    enum class Operation { Copy, Move, Destroy };
+
+    void copy_from(const JobFunction& other) {
+        if (other.manage_ != nullptr) {
+            other.manage_(Operation::Copy, storage_, const_cast<std::byte*>(other.storage_));
+        } else {
+            std::memcpy(storage_, other.storage_, STORAGE_SIZE);
+        }
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+    }
+
+    void move_from(JobFunction& other) {
+        if (other.manage_ != nullptr) {
+            other.manage_(Operation::Move, storage_, other.storage_);
+        } else {
+            std::memcpy(storage_, other.storage_, STORAGE_SIZE);
+        }
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
+    }
+
+    alignas(STORAGE_ALIGNMENT) std::byte storage_[STORAGE_SIZE] = {};
+    void (*invoke_)(void* storage) = nullptr;
+    // Only set for callables that can't be copied with memcpy
+    void (*manage_)(Operation operation, void* dest, void* src) = nullptr;
+};
+
+static_assert(sizeof(JobFunction) == 64, "JobFunction should fill exactly one cache line");
+} // namespace vee
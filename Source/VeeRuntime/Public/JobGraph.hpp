@@ -0,0 +1,106 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include "JobCounter.hpp"
+#include "JobFunction.hpp"
+#include "JobManager.hpp"
+#include "Name.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace vee {
+struct JobGraphNode {
+    uint32_t index;
+};
+
+/**
+ * A set of jobs and the dependencies between them, declared once and then run as many times as
+ * needed, e.g. once per frame.
+ *
+ * compile() flattens the graph into arrays of nodes and successor lists with a precomputed number
+ * of dependencies per node. Each run resets the pending dependency counts in one pass and queues
+ * the root nodes as a single batch. When a node finishes it decrements the count of each of its
+ * successors and queues the ones that reached zero, so no counters need to be wired up by hand.
+ */
+class JobGraph {
+public:
+    JobGraph() = default;
+    JobGraph(const JobGraph&) = delete;
+    JobGraph& operator=(const JobGraph&) = delete;
+
+    JobGraphNode add_node(Name name, JobFunction entry, JobPriority priority = JobPriority::Normal);
+    /**
+     * Declare that after may only start once before has finished.
+     */
+    void add_dependency(JobGraphNode before, JobGraphNode after);
+
+    /**
+     * Validate the graph and build the flat representation used by run(). Must be called after the
+     * last node or dependency was added, and before the first run.
+     */
+    void compile();
+
+    /**
+     * Queue every node of the graph. Nodes start as soon as all of their dependencies have finished.
+     * The graph must not be run again or destroyed before the previous run is complete.
+     * @param wait_counter If set, no node starts until this counter reaches zero.
+     */
+    void run(JobCounter* wait_counter = nullptr);
+
+    /**
+     * Reaches zero once every node of the last run has finished. Can be passed to
+     * JobManager::wait_for_counter or used as the wait counter of other jobs.
+     */
+    JobCounter& counter() {
+        return counter_;
+    }
+
+    [[nodiscard]] bool is_complete() const {
+        return counter_.is_complete();
+    }
+
+private:
+    struct Node {
+        Name name;
+        JobFunction entry;
+        JobPriority priority = JobPriority::Normal;
+        uint32_t num_dependencies = 0;
+        // Range in successors_
+        uint32_t first_successor = 0;
+        uint32_t num_successors = 0;
+    };
+
+    void run_node(uint32_t index);
+
+    std::vector<Node> nodes_;
+    // Declared edges, only used by compile()
+    std::vector<std::pair<uint32_t, uint32_t>> dependencies_;
+
+    std::vector<uint32_t> successors_;
+    // Jobs for the nodes without dependencies, queued as one batch by run()
+    std::vector<JobDecl> root_jobs_;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending_dependencies_;
+    bool compiled_ = false;
+
+    JobCounter counter_;
+};
+} // namespace vee
@@ -14,26 +14,329 @@
 
 #pragma once
 
+#include "JobCounter.hpp"
+#include "JobFunction.hpp"
 #include "Name.hpp"
 
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <vector>
 
 namespace vee {
 
+enum class JobPriority : uint8_t {
+    /**
+     * Work the current frame is waiting on. While any of these jobs are pending, background jobs
+     * are throttled.
+     */
+    Critical,
+    Normal,
+    /**
+     * Work that may take several frames, such as asset decoding or shader compilation.
+     */
+    Background,
+};
+
+constexpr std::size_t NUM_JOB_PRIORITIES = 3;
+
+/**
+ * Size of the fiber stack a job runs on. Fibers are pooled per size, so smaller stacks cut the
+ * memory held by suspended jobs. Overflowing the stack hits a guard page and crashes, use
+ * JobManager::stack_usage in development builds to find out what a job needs.
+ */
+enum class JobStackSize : uint8_t {
+    /**
+     * 32 KiB
+     */
+    Small,
+    /**
+     * 128 KiB
+     */
+    Medium,
+    /**
+     * 512 KiB
+     */
+    Large,
+};
+
+constexpr std::size_t NUM_JOB_STACK_SIZES = 3;
+
 struct JobDecl {
     Name name;
-    void (*entry)();
-    std::atomic<uint32_t>* signal_counter = nullptr;
+    /**
+     * Function or lambda to run. Captures are stored inline in the job, see JobFunction.
+     */
+    JobFunction entry;
+    JobCounter* signal_counter = nullptr;
+    JobPriority priority = JobPriority::Normal;
+    /**
+     * Only run the job on the main thread, for work such as window events or present that isn't
+     * allowed anywhere else. The main thread runs these in run_main_thread_jobs or while it waits
+     * in wait_for_counter. The job stays on the main thread even after it suspends.
+     */
+    bool main_thread_only = false;
+    /**
+     * The job never yields, waits for a counter or otherwise suspends, including through
+     * FiberMutex and friends. Leaf jobs run directly on the worker's stack instead of switching to
+     * a fiber, which is much cheaper for small jobs. Suspending a leaf job asserts.
+     */
+    bool leaf = false;
+    JobStackSize stack_size = JobStackSize::Large;
+};
+
+enum class WorkerPlacement {
+    /**
+     * One worker per physical core, limited to the fastest cores of the group sharing a last level
+     * cache. Workers stealing from each other then never have to go through main memory. The
+     * group with the most fast cores is picked, or the one with the largest cache on a tie.
+     */
+    SharedCache,
+    /**
+     * One worker per physical core across every cache domain.
+     */
+    PhysicalCores,
+    /**
+     * One worker per physical core, but leave scheduling entirely to the OS.
+     */
+    Unpinned,
+};
+
+struct JobManagerConfig {
+    /**
+     * Number of worker threads to spawn. 0 picks a count based on the CPU and the placement
+     * policy, leaving one core to the main thread. Workers beyond the cores picked by the policy
+     * spill onto the remaining physical cores, then onto SMT siblings.
+     */
+    std::size_t num_workers = 0;
+    WorkerPlacement placement = WorkerPlacement::SharedCache;
+    /**
+     * Number of large stack job fibers to create up front so that the first jobs don't pay for
+     * stack allocation.
+     */
+    std::size_t initial_fiber_pool_size = 0;
+};
+
+struct FiberPoolStats {
+    /**
+     * Jobs that started on a recycled fiber.
+     */
+    uint64_t hits = 0;
+    /**
+     * Jobs that needed a newly created fiber.
+     */
+    uint64_t misses = 0;
+    /**
+     * Fibers currently alive, both pooled and in use.
+     */
+    std::size_t num_fibers = 0;
+    /**
+     * Stack memory reserved by those fibers.
+     */
+    std::size_t stack_bytes = 0;
+};
+
+struct JobStackUsage {
+    Name name;
+    /**
+     * Most fiber stack any run of the job used.
+     */
+    std::size_t peak_bytes = 0;
+    /**
+     * Stack size the job last ran with.
+     */
+    JobStackSize stack_size = JobStackSize::Large;
+};
+
+/**
+ * Number of buckets in a queue latency histogram. Bucket 0 counts latencies below 1us, bucket i
+ * counts latencies in [2^(i-1), 2^i)us, and the last bucket also counts everything above that.
+ */
+constexpr std::size_t NUM_QUEUE_LATENCY_BUCKETS = 16;
+
+struct WorkerStats {
+    /**
+     * Jobs started or resumed by the worker.
+     */
+    uint64_t jobs_run = 0;
+    /**
+     * Jobs taken from another worker's deque.
+     */
+    uint64_t steals = 0;
+    /**
+     * Times a job running on the worker suspended on a counter or parked, for example on a
+     * FiberMutex or an async file read.
+     */
+    uint64_t suspends = 0;
+    /**
+     * Time spent searching for work or parked.
+     */
+    uint64_t idle_ns = 0;
+    /**
+     * Time from a job becoming ready until the worker started or resumed it.
+     */
+    std::array<uint64_t, NUM_QUEUE_LATENCY_BUCKETS> queue_latency = {};
+};
+
+/**
+ * Identifies a job queued with JobManager::queue_periodic_job.
+ */
+struct PeriodicJobHandle {
+    uint64_t id = 0;
+};
+
+struct JobManagerStats {
+    std::vector<WorkerStats> workers;
+    /**
+     * Time since JobManager::init, for turning idle time into utilization.
+     */
+    uint64_t elapsed_ns = 0;
 };
 
 namespace JobManager {
-    void init();
+    /**
+     * Start the worker threads. The calling thread becomes the main thread: it runs jobs while it
+     * waits in wait_for_counter, and is the only thread that runs main-thread-only jobs.
+     */
+    void init(JobManagerConfig config = {});
+    /**
+     * Stop the worker threads. Must be called from the main thread.
+     */
     void shutdown();
 
-    void queue_job(JobDecl decl, std::atomic<uint32_t>* wait_counter = nullptr);
+    /**
+     * Queue a job to run on a worker.
+     * @param decl The job to run.
+     * @param wait_counter If set, the job won't start until this counter drops to wait_target.
+     * @param wait_target Value of wait_counter to wait for, zero to wait for it to complete.
+     */
+    void queue_job(JobDecl decl, JobCounter* wait_counter = nullptr, uint32_t wait_target = 0);
+    /**
+     * Queue a batch of jobs. The whole batch is published to the scheduler at once and signal
+     * counters shared between consecutive jobs are only updated once.
+     * @param decls The jobs to run.
+     * @param wait_counter If set, none of the jobs start until this counter drops to wait_target.
+     * @param wait_target Value of wait_counter to wait for, zero to wait for it to complete.
+     */
+    void queue_jobs(std::span<const JobDecl> decls, JobCounter* wait_counter = nullptr, uint32_t wait_target = 0);
+    /**
+     * Queue a job to run once delay has passed. Timers have a resolution of one millisecond and
+     * never fire early. The signal counter is incremented right away, so waiting on it also waits
+     * for the delayed job.
+     */
+    void queue_job_after(std::chrono::nanoseconds delay, JobDecl decl);
+    /**
+     * Queue a copy of decl every period, starting one period from now, until the job is
+     * cancelled. Runs that were missed because the scheduler fell behind are skipped rather than
+     * run back to back. Every run increments and signals the signal counter like a regular job.
+     */
+    PeriodicJobHandle queue_periodic_job(std::chrono::nanoseconds period, JobDecl decl);
+    /**
+     * Stop queueing a periodic job. A run that was already queued still completes.
+     */
+    void cancel_periodic_job(PeriodicJobHandle handle);
+    /**
+     * @return The number of worker threads, not counting the main thread.
+     */
     std::size_t num_workers();
+    /**
+     * @return Index of the calling thread, 0 for the main thread and 1 to num_workers() for the
+     * worker threads. Meant for indexing per-thread data such as command pools. A job that suspends
+     * may resume on a different thread, so only leaf jobs can rely on the index staying the same.
+     */
+    std::size_t current_worker_index();
+    FiberPoolStats fiber_pool_stats();
+    /**
+     * Snapshot of the per-worker scheduler counters, the main thread first. Counters are only
+     * collected when built with VEE_JOB_STATS, otherwise everything but elapsed_ns stays zero.
+     */
+    JobManagerStats stats();
+    /**
+     * Send the change in stats() since the previous call to Tracy as plots. Meant to be called
+     * once per frame from the main thread.
+     */
+    void plot_stats();
+    /**
+     * Peak fiber stack usage per job name, largest first. Stacks are only measured when built with
+     * VEE_FIBER_STACK_PAINTING, otherwise this is empty. Leaf jobs run on the worker's stack and
+     * are never measured.
+     */
+    std::vector<JobStackUsage> stack_usage();
 
     void yield();
     void terminate();
-    void wait_for_counter(std::atomic<uint32_t>* counter);
+    /**
+     * Suspend the current job until counter drops to target. The worker runs other jobs in the
+     * meantime. Outside a job, the main thread runs queued jobs itself until then, and any other
+     * thread blocks.
+     * @param target Value to wait for. Zero waits for the counter to complete, after which it may be
+     * destroyed.
+     */
+    void wait_for_counter(JobCounter* counter, uint32_t target = 0);
+    /**
+     * Run the main-thread-only jobs that are ready. Call regularly from the main thread outside of
+     * a job, such as once per frame.
+     */
+    void run_main_thread_jobs();
+
+    namespace detail {
+        using RangeFn = void (*)(void* fn, std::size_t begin, std::size_t end);
+        void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, RangeFn invoke, void* fn);
+
+        /**
+         * Account for count pieces of work other than jobs that will signal counter, such as
+         * tasks.
+         */
+        void add_to_counter(JobCounter& counter, uint32_t count);
+        /**
+         * Signal one piece of work accounted for with add_to_counter as done.
+         */
+        void signal_counter(JobCounter& counter);
+    } // namespace detail
+
+    /**
+     * Call fn over [begin, end) split into chunks on the worker pool and wait until every chunk
+     * has finished. Chunks run at the priority of the calling job, or at normal priority outside of
+     * a job. The range is handed out in a few large pieces up front, and pieces are split in
+     * half again only while other workers are starved for work, so the number of jobs adapts to
+     * the load instead of being one per element.
+     * @param grain Smallest chunk size that will be handed to fn.
+     * @param fn Called as fn(chunk_begin, chunk_end), possibly from several threads at once.
+     */
+    template <typename Fn>
+        requires std::invocable<Fn&, std::size_t, std::size_t>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Fn&& fn) {
+        detail::parallel_for(
+            begin,
+            end,
+            grain,
+            [](void* erased_fn, std::size_t chunk_begin, std::size_t chunk_end) {
+                std::invoke(*static_cast<std::remove_reference_t<Fn>*>(erased_fn), chunk_begin, chunk_end);
+            },
+            const_cast<void*>(static_cast<const void*>(std::addressof(fn)))
+        );
+    }
+
+    /**
+     * Call fn for each element of range on the worker pool and wait until all of them have been
+     * processed.
+     * @see parallel_for(std::size_t, std::size_t, std::size_t, Fn&&)
+     */
+    template <std::ranges::random_access_range Range, typename Fn>
+        requires std::ranges::sized_range<Range> && std::invocable<Fn&, std::ranges::range_reference_t<Range>>
+    void parallel_for(Range&& range, std::size_t grain, Fn&& fn) {
+        auto first = std::ranges::begin(range);
+        parallel_for(0, std::ranges::size(range), grain, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+            for (std::size_t i = chunk_begin; i < chunk_end; ++i) {
+                std::invoke(fn, first[static_cast<std::iter_difference_t<decltype(first)>>(i)]);
+            }
+        });
+    }
 };
 } // namespace vee
@@ -15,8 +15,32 @@
 
 #pragma once
 
+#include "Task.hpp"
+
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace vee::platform::filesystem {
 [[nodiscard]] std::vector<std::byte> read_binary_file(const char* filename);
-}
\ No newline at end of file
+
+/**
+ * Start the asynchronous I/O backend. Requires JobManager to be initialized.
+ */
+void init_async_io();
+void shutdown_async_io();
+
+/**
+ * Read a whole file. Inside a job, the job is suspended while the reads are in flight and the
+ * worker runs other jobs. Outside of a job, or if the asynchronous backend isn't available, the
+ * calling thread blocks instead.
+ * @return The file contents, or nullopt if the file couldn't be opened or read.
+ */
+[[nodiscard]] std::optional<std::vector<std::byte>> read_binary_file_async(const char* filename);
+
+/**
+ * read_binary_file_async for tasks. The read runs as a job, which only holds on to a fiber while
+ * the read is in flight, and the task resumes once it finished.
+ */
+Task<std::optional<std::vector<std::byte>>> read_binary_file_task(std::string filename);
+} // namespace vee::platform::filesystem
\ No newline at end of file
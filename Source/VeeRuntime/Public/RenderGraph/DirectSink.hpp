@@ -20,6 +20,7 @@
 #include "MakeSharedEnabler.hpp"
 
 #include <memory>
+#include <type_traits>
 
 namespace vee::rdg {
 template <typename T>
@@ -30,6 +31,16 @@ public:
     }
     std::shared_ptr<T>& target;
 
+    ResourceRef resource() const override {
+        if constexpr (std::is_same_v<T, ImageResource>) {
+            return {.image = &target};
+        } else if constexpr (std::is_same_v<T, Buffer>) {
+            return {.buffer = &target};
+        } else {
+            return {};
+        }
+    }
+
 protected:
     explicit DirectSink(std::shared_ptr<T>& target)
         : Sink()
@@ -20,6 +20,8 @@
 #include "RenderGraph/RenderGraph.hpp"
 #include "RenderGraph/Source.hpp"
 
+#include <type_traits>
+
 namespace vee::rdg {
 template <typename T>
 class DirectSource : public Source {
@@ -45,6 +47,16 @@ public:
         }
     }
 
+    ResourceRef resource() const override {
+        if constexpr (std::is_same_v<T, ImageResource>) {
+            return {.image = &target};
+        } else if constexpr (std::is_same_v<T, Buffer>) {
+            return {.buffer = &target};
+        } else {
+            return {};
+        }
+    }
+
 
 protected:
     explicit DirectSource(std::shared_ptr<T>& target)
@@ -26,5 +26,6 @@ public:
     vk::ImageView view;
     uint32_t width;
     uint32_t height;
+    vk::Format format;
 };
 } // namespace vee::rdg
@@ -16,10 +16,13 @@
 #pragma once
 
 #include "Handles.hpp"
+#include "ResourceUsage.hpp"
 
 
+#include <cstddef>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <unordered_map>
 #include <vulkan/vulkan.hpp>
 
@@ -27,16 +30,62 @@ namespace vee::rdg {
 class Source;
 class Sink;
 
+/**
+ * Rendering that the chunks of a split Pass record into.
+ */
+struct ChunkedRendering {
+    /**
+     * Begun by the RenderGraph around the chunks. The attachments it points to must stay alive
+     * until the frame is recorded.
+     */
+    vk::RenderingInfo info;
+    /**
+     * Formats of the color attachments in info, inherited by every chunk.
+     */
+    std::span<const vk::Format> color_formats;
+};
+
 class Pass {
 public:
     virtual ~Pass();
 
     /**
-     * Called by the RenderGraph every frame. Record rendering commands here.
-     * @param cmd Command Buffer for rendering.
+     * Called by the RenderGraph every frame, usually on a JobManager worker and at the same time
+     * as other Passes. Record rendering commands here.
+     * @param cmd Secondary Command Buffer for rendering.
      */
     virtual void execute(vk::CommandBuffer cmd) = 0;
 
+    /**
+     * Called by the RenderGraph every frame on the main thread, before any Pass records. Large
+     * Passes can split their recording into chunks here that record on several workers at once.
+     * @return Number of chunks to record with execute_chunk, or 1 to record with execute.
+     */
+    virtual std::size_t prepare_chunks() {
+        return 1;
+    }
+
+    /**
+     * @return The rendering the chunks record into. Only called when prepare_chunks returned more
+     * than one chunk.
+     */
+    virtual ChunkedRendering chunk_rendering() {
+        return {};
+    }
+
+    /**
+     * Record one chunk of a split Pass, called from several workers at once. Rendering is already
+     * begun, but dynamic state such as the viewport isn't inherited and has to be set again.
+     * @param cmd Secondary Command Buffer continuing the rendering from chunk_rendering.
+     * @param chunk Index of the chunk to record.
+     * @param num_chunks Number of chunks returned by prepare_chunks.
+     */
+    virtual void execute_chunk([[maybe_unused]] vk::CommandBuffer cmd, [[maybe_unused]] std::size_t chunk, [[maybe_unused]] std::size_t num_chunks) {}
+
+    [[nodiscard]] bool is_main_thread_only() const {
+        return main_thread_only_;
+    }
+
     /**
      * Link an external Sink to a Source belonging to this Pass. Linked Sinks may be global to the
      * Render Graph or a Sink belonging to another Pass in the Render Graph.
@@ -77,23 +126,29 @@ public:
 protected:
     std::unordered_map<SourceHandle, std::unique_ptr<Source>> sources_;
     std::unordered_map<SinkHandle, std::unique_ptr<Sink>> sinks_;
-
+    /**
+     * Record the Pass on the main thread, for Passes built on libraries that aren't thread safe.
+     */
+    bool main_thread_only_ = false;
 
     /**
      * Register a Source with this Pass and assign it a handle that will be used to refer to it
      * later. Call this during construction of the Pass.
      * @param name Handle to assign
      * @param source Source to register
+     * @param usage How execute uses the resource the Source resolves to. The RenderGraph
+     * transitions and synchronizes the resource accordingly before the Pass executes.
      */
-    void register_source(SourceHandle name, std::unique_ptr<Source> source);
+    void register_source(SourceHandle name, std::unique_ptr<Source> source, ResourceUsage usage = ResourceUsage::None);
 
     /**
      * Register a Sink with thes Pass and assign it a handle that will be used to refer to it later.
      * Call this during construction of the Pass.
      * @param name Handle to assign
      * @param sink SInk to register
+     * @param usage How execute uses the resource behind the Sink.
      */
-    void register_sink(SinkHandle name, std::unique_ptr<Sink> sink);
+    void register_sink(SinkHandle name, std::unique_ptr<Sink> sink, ResourceUsage usage = ResourceUsage::None);
 
     friend class RenderGraph;
 };
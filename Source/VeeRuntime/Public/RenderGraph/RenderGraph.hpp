@@ -16,9 +16,13 @@
 #pragma once
 
 #include "RenderGraph/Handles.hpp"
+#include "RenderGraph/ResourceUsage.hpp"
 
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
@@ -28,9 +32,13 @@ class Buffer;
 class RenderCtx;
 } // namespace vee
 namespace vee::rdg {
+class CopyBufferSink;
 class ImageResource;
 class Pass;
+class ResourceStateTracker;
+class SecondaryCommandPools;
 class Sink;
+class TransientImagePool;
 
 /**
  * PassHandle for referring to Sinks/Sources owned by the RenderGraph itself.
@@ -38,11 +46,70 @@ class Sink;
 extern const Name GLOBAL;
 
 /**
- * A compiled/built RenderGraph
+ * Order the Passes of a RenderGraph run in, derived from how their Sources are linked to the Sinks
+ * of other Passes. Passes are grouped into levels: a Pass only depends on Passes of earlier levels,
+ * so the Passes within one level are independent of each other.
+ */
+struct RenderGraphSchedule {
+    /**
+     * Every Pass in a valid execution order, level by level. Within a level, Passes keep the order
+     * they were added in.
+     */
+    std::vector<PassHandle> pass_order;
+    /**
+     * Index into pass_order of the first Pass of each level, followed by pass_order.size().
+     */
+    std::vector<std::size_t> level_offsets = {0};
+
+    [[nodiscard]] std::size_t num_levels() const {
+        return level_offsets.size() - 1;
+    }
+
+    /**
+     * @return The Passes of a level, none of which depend on each other.
+     */
+    [[nodiscard]] std::span<const PassHandle> level(std::size_t index) const {
+        return std::span(pass_order).subspan(level_offsets[index], level_offsets[index + 1] - level_offsets[index]);
+    }
+};
+
+/**
+ * An image that only lives for part of a frame, owned by the RenderGraph. Transient images are
+ * global Sinks that Passes link to like any other. Their usage flags are derived from how Passes
+ * declare they use them.
+ */
+struct TransientImageDesc {
+    uint32_t width;
+    uint32_t height;
+    vk::Format format;
+};
+
+struct TransientMemoryStats {
+    /**
+     * Memory the transient images of one frame would need if each had its own.
+     */
+    std::size_t unaliased_bytes = 0;
+    /**
+     * Memory they take per frame in flight, with images whose lifetimes don't overlap sharing it.
+     */
+    std::size_t aliased_bytes = 0;
+};
+
+/**
+ * A compiled/built RenderGraph. Everything execute needs is resolved up front into arrays in
+ * schedule order, handles are only looked up while building.
  */
 class RenderGraph {
 public:
-    RenderGraph(std::unordered_map<PassHandle, std::unique_ptr<Pass>>&& passes, std::vector<PassHandle>&& pass_order, RenderCtx& ctx);
+    /**
+     * @param passes Every Pass, in the order of schedule.pass_order.
+     */
+    RenderGraph(
+        std::vector<std::unique_ptr<Pass>>&& passes,
+        RenderGraphSchedule&& schedule,
+        std::span<const std::pair<SinkHandle, TransientImageDesc>> transient_images,
+        RenderCtx& ctx
+    );
     ~RenderGraph();
 
     RenderGraph(RenderGraph&& other);
@@ -50,7 +117,11 @@ public:
     RenderGraph(const RenderGraph&) = delete;
     RenderGraph& operator=(const RenderGraph&) = delete;
 
-    void execute(RenderCtx& render_ctx) const;
+    /**
+     * Record and submit a frame. Passes record into secondary command buffers on the JobManager
+     * workers, so JobManager must be running.
+     */
+    void execute(RenderCtx& render_ctx);
 
     /**
      * Find a sink owned by a Pass belonging to this RenderGraph.
@@ -59,15 +130,48 @@ public:
      */
     Sink* find_sink(SinkRef ref) const;
 
+    const RenderGraphSchedule& schedule() const {
+        return schedule_;
+    }
+
+    TransientMemoryStats transient_memory_stats() const;
+
 protected:
-    std::unordered_map<PassHandle, std::unique_ptr<Pass>> passes_;
-    std::vector<PassHandle> pass_order_;
+    void create_transient_images(std::span<const std::pair<SinkHandle, TransientImageDesc>> transient_images, RenderCtx& render_ctx);
+
+    struct ResourceAccess {
+        ResourceRef resource;
+        ResourceUsage usage;
+    };
+
+    std::span<const ResourceAccess> pass_accesses(std::size_t pass_index) const {
+        return std::span(accesses_).subspan(access_offsets_[pass_index], access_offsets_[pass_index + 1] - access_offsets_[pass_index]);
+    }
+
+    // In schedule order
+    std::vector<std::unique_ptr<Pass>> passes_;
+    // Index into passes_ of every PassHandle, for find_sink
+    std::unordered_map<PassHandle, std::size_t> pass_indices_;
+    RenderGraphSchedule schedule_;
+    // Resource uses declared by every Pass, grouped by Pass in schedule order
+    std::vector<ResourceAccess> accesses_;
+    // Index into accesses_ of the first use of each Pass, followed by accesses_.size()
+    std::vector<std::size_t> access_offsets_ = {0};
+    // Sinks that asked for prepare to be called every frame, in schedule order
+    std::vector<Sink*> prepared_sinks_;
+    // Where FrameImageReadbackPass copies the frame image for Tracy, if the Pass exists
+    CopyBufferSink* frame_image_sink_ = nullptr;
+    std::unique_ptr<ResourceStateTracker> resource_states_;
+    std::unique_ptr<TransientImagePool> transient_images_;
+    // Created on the first execute, JobManager may not be running yet when the RenderGraph is built
+    std::unique_ptr<SecondaryCommandPools> secondary_pools_;
 
     std::unordered_map<SinkHandle, std::unique_ptr<Sink>> global_sinks_;
 
     std::shared_ptr<ImageResource> framebuffer_;
     std::shared_ptr<Buffer> vertex_buffer_;
     std::shared_ptr<Buffer> index_buffer_;
+    std::vector<std::shared_ptr<ImageResource>> transient_image_resources_;
 
     vk::Semaphore buffer_semaphore_;
 };
@@ -51,15 +51,35 @@ public:
     }
 
     /**
-     * Compile a RenderGraph. This builder is invalidated afterward.
+     * Declare an image owned by the RenderGraph that Passes link to as the global Sink name. The
+     * image only holds memory from the first to the last Pass that uses it, and shares it with
+     * transient images used outside that range. Its contents don't survive the frame.
+     *
+     * At most one Pass may write the image through the global Sink (as a TransferDst,
+     * ColorAttachment or Storage Source). Every other Pass linking the global Sink only reads it and
+     * is scheduled after that writer. A Pass that writes the image again links to the writer's Sink
+     * instead, so it is ordered like any other link.
+     */
+    void add_transient_image(SinkHandle name, TransientImageDesc desc);
+
+    /**
+     * Compile a RenderGraph. Passes are ordered so that each runs after every Pass it links a Sink
+     * from. Linking to a Pass or Sink that doesn't exist, leaving a Source unlinked, or linking
+     * Passes in a cycle asserts. This builder is invalidated afterward.
      * @param render_ctx Engine global rendering context
      * @return Compiled RenderGraph
      */
     RenderGraph build(RenderCtx& render_ctx);
 
 protected:
+    /**
+     * Validate the links between Passes and sort the Passes topologically.
+     */
+    RenderGraphSchedule schedule_passes() const;
+
     std::unordered_map<PassHandle, std::unique_ptr<Pass>> passes_;
     std::vector<PassHandle> pass_order_;
+    std::vector<std::pair<SinkHandle, TransientImageDesc>> transient_images_;
 };
 
 } // namespace vee::rdg
\ No newline at end of file
@@ -0,0 +1,77 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace vee {
+class Buffer;
+}
+
+namespace vee::rdg {
+class ImageResource;
+
+/**
+ * How a Pass uses the image or buffer behind one of its Sources or Sinks while it executes. The
+ * RenderGraph inserts the layout transitions and barriers needed between uses, so Passes only
+ * record their own commands.
+ */
+enum class ResourceUsage : uint8_t {
+    /**
+     * Not synchronized by the RenderGraph, for resources that don't change during a frame such as
+     * vertex buffers.
+     */
+    None,
+    /**
+     * Read and written as a color attachment of dynamic rendering.
+     */
+    ColorAttachment,
+    /**
+     * Source of a copy or blit.
+     */
+    TransferSrc,
+    /**
+     * Destination of a copy, blit or clear.
+     */
+    TransferDst,
+    /**
+     * Sampled from fragment or compute shaders.
+     */
+    Sampled,
+    /**
+     * Read and written as a storage image or buffer from fragment or compute shaders.
+     */
+    Storage,
+    /**
+     * Handed to the presentation engine. Only used by the RenderGraph itself at the end of a frame.
+     */
+    Present,
+};
+
+/**
+ * Points at the image or buffer a Source or Sink refers to, so the RenderGraph can synchronize it.
+ * At most one of the two is set.
+ */
+struct ResourceRef {
+    const std::shared_ptr<ImageResource>* image = nullptr;
+    const std::shared_ptr<Buffer>* buffer = nullptr;
+
+    [[nodiscard]] bool empty() const {
+        return image == nullptr && buffer == nullptr;
+    }
+};
+} // namespace vee::rdg
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "RenderGraph/ResourceUsage.hpp"
+
 namespace vee {
 class RenderCtx;
 }
@@ -33,9 +35,28 @@ public:
     virtual void init([[maybe_unused]] RenderCtx& ctx) {};
 
     /**
-     * Called by the RenderGraph each frame before execution.
+     * Called by the RenderGraph each frame before execution, if prepare_every_frame is set.
      * @param ctx
      */
      virtual void prepare([[maybe_unused]] const RenderGraph& ctx) {};
+
+    /**
+     * @return The image or buffer behind this Sink, if the RenderGraph can synchronize it.
+     */
+    virtual ResourceRef resource() const {
+        return {};
+    }
+
+    /**
+     * How the owning Pass uses the resource, set when the Sink is registered. Sinks that pass on
+     * the resource of one of the Pass's Sources leave this as None, the use is declared on the
+     * Source.
+     */
+    ResourceUsage usage = ResourceUsage::None;
+    /**
+     * Set by Sinks that override prepare. The RenderGraph only keeps these around to prepare each
+     * frame.
+     */
+    bool prepare_every_frame = false;
 };
 } // namespace vee::rdg
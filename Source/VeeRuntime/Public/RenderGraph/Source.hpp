@@ -16,6 +16,7 @@
 #pragma once
 
 #include "RenderGraph/Handles.hpp"
+#include "RenderGraph/ResourceUsage.hpp"
 
 
 namespace vee::rdg {
@@ -25,6 +26,17 @@ public:
     virtual ~Source() = default;
     virtual void resolve(const RenderGraph& rg) = 0;
 
+    /**
+     * @return The image or buffer this Source resolved to, if the RenderGraph can synchronize it.
+     */
+    virtual ResourceRef resource() const {
+        return {};
+    }
+
     SinkRef sink_ref = {};
+    /**
+     * How the owning Pass uses the resource, set when the Source is registered.
+     */
+    ResourceUsage usage = ResourceUsage::None;
 };
 } // namespace vee::rdg
@@ -53,6 +53,7 @@ public:
     Swapchain swapchain;
     vk::Queue graphics_queue;
     vk::Queue presentation_queue;
+    uint32_t graphics_queue_family;
     vk::CommandPool command_pool;
     vma::Allocator allocator;
 
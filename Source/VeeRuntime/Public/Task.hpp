@@ -0,0 +1,248 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#pragma once
+
+#include "JobCounter.hpp"
+#include "JobManager.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+
+namespace vee {
+template <typename T = void>
+class Task;
+
+namespace detail {
+    /**
+     * Coroutine frames come from size-classed free lists with worker-local caches, so starting a
+     * task doesn't go through the general purpose allocator.
+     */
+    void* allocate_task_frame(std::size_t size);
+    void free_task_frame(void* frame, std::size_t size) noexcept;
+
+    /**
+     * Queue a job that resumes handle on the worker pool once wait_counter reaches zero.
+     * @param wait_counter May be nullptr to resume as soon as a worker is free.
+     */
+    void schedule_resume(std::coroutine_handle<> handle, JobCounter* wait_counter, JobPriority priority, bool main_thread_only);
+
+    /**
+     * How the job running the current task was queued, so that awaiting a JobCounter resumes the
+     * task the same way.
+     */
+    struct ResumeContext {
+        JobPriority priority = JobPriority::Normal;
+        bool main_thread_only = false;
+    };
+
+    /**
+     * @return Context of the task running on this thread, or the defaults outside of one.
+     */
+    ResumeContext current_resume_context();
+
+    struct TaskPromiseBase {
+        // Resumed when the task finishes. Nobody awaits a task that was never started.
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        static void* operator new(std::size_t size) {
+            return allocate_task_frame(size);
+        }
+        static void operator delete(void* frame, std::size_t size) noexcept {
+            free_task_frame(frame, size);
+        }
+
+        /**
+         * Tasks are lazy, they only start running once awaited or spawned.
+         */
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept {
+                return false;
+            }
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept {
+                return finished.promise().continuation;
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    template <typename T>
+    struct TaskPromise : TaskPromiseBase {
+        std::optional<T> value;
+
+        Task<T> get_return_object() noexcept;
+
+        template <typename U>
+            requires std::convertible_to<U&&, T>
+        void return_value(U&& result) {
+            value.emplace(std::forward<U>(result));
+        }
+    };
+
+    template <>
+    struct TaskPromise<void> : TaskPromiseBase {
+        Task<void> get_return_object() noexcept;
+
+        void return_void() noexcept {}
+    };
+
+    /**
+     * Resumes the awaiting coroutine as a new job, optionally once a counter reaches zero.
+     */
+    struct ResumeAwaiter {
+        JobCounter* wait_counter = nullptr;
+        JobPriority priority = JobPriority::Normal;
+        bool main_thread_only = false;
+
+        bool await_ready() const noexcept {
+            return wait_counter != nullptr && wait_counter->is_complete();
+        }
+        void await_suspend(std::coroutine_handle<> awaiting) const {
+            schedule_resume(awaiting, wait_counter, priority, main_thread_only);
+        }
+        void await_resume() const noexcept {}
+    };
+} // namespace detail
+
+/**
+ * A stackless coroutine that runs on the JobManager worker pool. A suspended task only keeps its
+ * coroutine frame alive, usually a few hundred bytes from a pooled allocator, whereas a suspended
+ * job holds on to a whole fiber stack. This makes tasks a good fit for long asynchronous chains
+ * that mostly wait, such as load -> decode -> upload.
+ *
+ * A task starts when it is awaited by another task, or when it is handed to spawn(). Awaiting a task
+ * runs it on the current thread until its first suspension point. Tasks can also await a
+ * JobCounter, after which they continue as a new job queued like the one they were running in.
+ *
+ * Tasks run as leaf jobs, so they must co_await rather than block the job with wait_for_counter,
+ * FiberMutex and the like.
+ */
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    /**
+     * @return True once the task ran to completion.
+     */
+    [[nodiscard]] bool is_done() const {
+        return handle_ && handle_.done();
+    }
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> task;
+
+            bool await_ready() const noexcept {
+                return task.done();
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                task.promise().continuation = awaiting;
+                return task;
+            }
+            decltype(auto) await_resume() {
+                if constexpr (!std::is_void_v<T>) {
+                    return T(std::move(*task.promise().value));
+                }
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+
+    friend promise_type;
+};
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+/**
+ * Suspend the task until counter reaches zero. It resumes as a job with the priority it was spawned
+ * or last resumed with, and stays on the main thread if it was resumed there.
+ */
+inline detail::ResumeAwaiter operator co_await(JobCounter& counter) {
+    const detail::ResumeContext context = detail::current_resume_context();
+    return {&counter, context.priority, context.main_thread_only};
+}
+
+/**
+ * Continue the task as a new job on the worker pool, e.g. to move work off the main thread.
+ */
+inline detail::ResumeAwaiter resume_on_worker(JobPriority priority = JobPriority::Normal) {
+    return {nullptr, priority};
+}
+
+/**
+ * Continue the task on the main thread, for work such as GPU uploads that has to happen there.
+ * @see JobDecl::main_thread_only
+ */
+inline detail::ResumeAwaiter resume_on_main_thread() {
+    return {nullptr, JobPriority::Normal, true};
+}
+
+/**
+ * Start running a task on the worker pool without waiting for it. The task owns itself from then
+ * on and frees its frame when it finishes.
+ * @param signal_counter If set, signaled once the task has finished, like a job's signal counter.
+ */
+void spawn(Task<void> task, JobCounter* signal_counter = nullptr, JobPriority priority = JobPriority::Normal);
+} // namespace vee
@@ -0,0 +1,166 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <AllocatorResource.hpp>
+#include <FrameMemory.hpp>
+#include <LinearAllocator.hpp>
+#include <PoolAllocator.hpp>
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+static bool is_aligned(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST_CASE("LinearAllocator hands out aligned, non-overlapping memory") {
+    using namespace vee;
+
+    LinearAllocator allocator(1024);
+    auto* first = static_cast<std::byte*>(allocator.allocate(3, 1));
+    auto* second = static_cast<std::byte*>(allocator.allocate(16, 64));
+
+    REQUIRE(is_aligned(second, 64));
+    REQUIRE(second >= first + 3);
+    REQUIRE(allocator.bytes_used() >= 19);
+}
+
+TEST_CASE("LinearAllocator grows past its chunk size and merges chunks on reset") {
+    using namespace vee;
+
+    LinearAllocator allocator(256);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(allocator.allocate(100) != nullptr);
+    }
+    REQUIRE(allocator.capacity() > 256);
+    REQUIRE(allocator.high_water_mark() >= 1000);
+
+    const std::size_t capacity = allocator.capacity();
+    allocator.reset();
+    REQUIRE(allocator.bytes_used() == 0);
+    REQUIRE(allocator.capacity() == capacity);
+
+    // Everything fits in the merged chunk, so nothing new is allocated
+    for (int i = 0; i < 10; ++i) {
+        static_cast<void>(allocator.allocate(100));
+    }
+    REQUIRE(allocator.capacity() == capacity);
+}
+
+TEST_CASE("LinearAllocator rewinds to a marker") {
+    using namespace vee;
+
+    LinearAllocator allocator(128);
+    static_cast<void>(allocator.allocate(32));
+    const std::size_t bytes_used = allocator.bytes_used();
+    const LinearAllocator::Marker marker = allocator.mark();
+    void* scratch = allocator.allocate(16);
+    for (int i = 0; i < 8; ++i) {
+        static_cast<void>(allocator.allocate(64));
+    }
+
+    allocator.rewind(marker);
+    REQUIRE(allocator.bytes_used() == bytes_used);
+    REQUIRE(allocator.allocate(16) == scratch);
+}
+
+TEST_CASE("PoolAllocator recycles blocks") {
+    using namespace vee;
+
+    PoolAllocator pool(24, 8, 4);
+    std::set<void*> blocks;
+    for (int i = 0; i < 10; ++i) {
+        void* block = pool.allocate();
+        REQUIRE(is_aligned(block, 8));
+        blocks.insert(block);
+    }
+    REQUIRE(blocks.size() == 10);
+    REQUIRE(pool.num_allocated() == 10);
+    REQUIRE(pool.capacity() == 12);
+
+    void* block = *blocks.begin();
+    pool.deallocate(block);
+    REQUIRE(pool.allocate() == block);
+
+    for (void* block : blocks) {
+        pool.deallocate(block);
+    }
+    REQUIRE(pool.num_allocated() == 0);
+    REQUIRE(pool.high_water_mark() == 10);
+}
+
+TEST_CASE("PoolAllocator constructs and destroys objects") {
+    using namespace vee;
+
+    struct Counted {
+        int& live;
+        explicit Counted(int& live)
+            : live(live) {
+            ++live;
+        }
+        ~Counted() {
+            --live;
+        }
+    };
+
+    int live = 0;
+    PoolAllocator pool(sizeof(Counted), alignof(Counted));
+    Counted* object = pool.create<Counted>(live);
+    REQUIRE(live == 1);
+    pool.destroy(object);
+    REQUIRE(live == 0);
+    REQUIRE(pool.num_allocated() == 0);
+}
+
+TEST_CASE("std::pmr containers can use our allocators") {
+    using namespace vee;
+
+    LinearAllocator allocator(64);
+    AllocatorResource resource(allocator);
+    std::pmr::vector<int> values(&resource);
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(i);
+    }
+
+    REQUIRE(values[99] == 99);
+    REQUIRE(allocator.bytes_used() >= 100 * sizeof(int));
+    REQUIRE(resource.is_equal(AllocatorResource(allocator)));
+}
+
+TEST_CASE("Frame memory resets at frame boundaries") {
+    using namespace vee;
+
+    FrameMemory::begin_frame();
+    {
+        std::pmr::vector<uint64_t> scratch(FrameMemory::resource());
+        scratch.resize(1000);
+    }
+    std::thread([] { static_cast<void>(FrameMemory::allocate<uint64_t>(500)); }).join();
+
+    // Threads that exit take their scratch memory with them, so only this one's is counted
+    const FrameMemoryStats stats = FrameMemory::begin_frame();
+    REQUIRE(stats.bytes_used >= 1000 * sizeof(uint64_t));
+    REQUIRE(stats.high_water_mark >= stats.bytes_used);
+    REQUIRE(FrameMemory::last_frame_stats().bytes_used == stats.bytes_used);
+
+    // Memory from the previous frame gets reused
+    void* first = FrameMemory::allocate(16);
+    FrameMemory::begin_frame();
+    REQUIRE(FrameMemory::allocate(16) == first);
+}
@@ -0,0 +1,108 @@
+//    Copyright 2025 Steven Casper
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <RenderGraph/TransientImagePool.hpp>
+
+#include <vector>
+
+using namespace vee::rdg;
+
+static bool lifetimes_overlap(const AliasRequest& a, const AliasRequest& b) {
+    return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+static bool memory_overlaps(const AliasRequest& a, vk::DeviceSize a_offset, const AliasRequest& b, vk::DeviceSize b_offset) {
+    return a_offset < b_offset + b.size && b_offset < a_offset + a.size;
+}
+
+static void require_valid_placement(const std::vector<AliasRequest>& requests, const std::vector<vk::DeviceSize>& offsets, vk::DeviceSize total_size) {
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        REQUIRE(offsets[i] % requests[i].alignment == 0);
+        REQUIRE(offsets[i] + requests[i].size <= total_size);
+        for (std::size_t j = i + 1; j < requests.size(); ++j) {
+            if (lifetimes_overlap(requests[i], requests[j])) {
+                REQUIRE(!memory_overlaps(requests[i], offsets[i], requests[j], offsets[j]));
+            }
+        }
+    }
+}
+
+TEST_CASE("place_aliased puts blocks with disjoint lifetimes at offset 0") {
+    const std::vector<AliasRequest> requests = {
+        {1000, 256, 0, 1},
+        {800, 256, 2, 3},
+        {600, 256, 4, 4},
+    };
+    std::vector<vk::DeviceSize> offsets(requests.size());
+    const vk::DeviceSize total_size = place_aliased(requests, offsets);
+
+    REQUIRE(offsets == std::vector<vk::DeviceSize>{0, 0, 0});
+    REQUIRE(total_size == 1000);
+}
+
+TEST_CASE("place_aliased never overlaps blocks whose lifetimes overlap") {
+    const std::vector<AliasRequest> requests = {
+        {1000, 256, 0, 1},
+        {800, 256, 2, 3},
+        {300, 256, 1, 2},
+        {100, 64, 3, 4},
+        {5000, 1024, 5, 5},
+        {700, 256, 0, 5},
+    };
+    std::vector<vk::DeviceSize> offsets(requests.size());
+    const vk::DeviceSize total_size = place_aliased(requests, offsets);
+
+    require_valid_placement(requests, offsets, total_size);
+    vk::DeviceSize unaliased_size = 0;
+    for (const AliasRequest& request : requests) {
+        unaliased_size += request.size;
+    }
+    REQUIRE(total_size < unaliased_size);
+}
+
+TEST_CASE("place_aliased respects each block's alignment") {
+    const std::vector<AliasRequest> requests = {
+        {100, 1, 0, 0},
+        {64, 4096, 0, 0},
+        {30, 64, 0, 0},
+        {7, 8, 0, 0},
+    };
+    std::vector<vk::DeviceSize> offsets(requests.size());
+    const vk::DeviceSize total_size = place_aliased(requests, offsets);
+
+    require_valid_placement(requests, offsets, total_size);
+    REQUIRE(offsets[1] == 4096);
+}
+
+TEST_CASE("place_aliased treats lifetimes sharing a pass as overlapping") {
+    // Both blocks are used by pass 2, so they can't share memory
+    const std::vector<AliasRequest> touching = {
+        {100, 1, 0, 2},
+        {100, 1, 2, 4},
+    };
+    std::vector<vk::DeviceSize> offsets(touching.size());
+    REQUIRE(place_aliased(touching, offsets) == 200);
+    REQUIRE(!memory_overlaps(touching[0], offsets[0], touching[1], offsets[1]));
+
+    // One pass later they can
+    const std::vector<AliasRequest> adjacent = {
+        {100, 1, 0, 1},
+        {100, 1, 2, 4},
+    };
+    REQUIRE(place_aliased(adjacent, offsets) == 100);
+    REQUIRE(offsets == std::vector<vk::DeviceSize>{0, 0});
+}